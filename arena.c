@@ -0,0 +1,176 @@
+/*
+arena.c
+
+Huge page allocation
+
+Implementations for memory backed by 2 MB huge pages, falling back to
+transparent huge pages and then to malloc.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+#define HUGEPAGESIZE ((size_t) 2 * 1024 * 1024)
+/* Room in front of every block for its header, keeping blocks aligned to a
+  cache line. */
+#define HEADERSIZE ((size_t) 64)
+/* Buffers taken from arenas start on a cache line. */
+#define ARENAALIGN ((size_t) 64)
+
+struct header {
+  enum backing backing;
+  /* Bytes asked for and, for mapped blocks, the length of the mapping. */
+  size_t bytes;
+  size_t length;
+};
+
+struct arena {
+  char *block;
+  size_t used;
+  size_t bytes;
+};
+
+static int hugePages = 1;
+
+void useHugePages(int enabled){
+  hugePages = enabled;
+}
+
+static size_t roundUp(size_t bytes, size_t multiple){
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+
+/* Maps length bytes on a huge page boundary, returning NULL on failure. */
+static void *mapHuge(size_t length, enum backing *backing){
+  char *mapped;
+  size_t lead;
+#ifdef MAP_HUGETLB
+  mapped = mmap(NULL, length, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if(mapped != MAP_FAILED){
+    *backing = BACKING_HUGETLB;
+    return mapped;
+  }
+#endif
+  /* No huge pages set aside, map an extra page so the block can start on a
+    huge page boundary and trim the rest. */
+  mapped = mmap(NULL, length + HUGEPAGESIZE, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(mapped == MAP_FAILED){
+    return NULL;
+  }
+  lead = roundUp((size_t) mapped, HUGEPAGESIZE) - (size_t) mapped;
+  if(lead > 0){
+    munmap(mapped, lead);
+  }
+  munmap(mapped + lead + length, HUGEPAGESIZE - lead);
+  mapped += lead;
+#ifdef MADV_HUGEPAGE
+  madvise(mapped, length, MADV_HUGEPAGE);
+#endif
+  *backing = BACKING_TRANSPARENT;
+  return mapped;
+}
+
+void *hugeAlloc(size_t bytes){
+  struct header *header = NULL;
+  enum backing backing = BACKING_MALLOC;
+  size_t length = 0;
+  /* Blocks smaller than a huge page would waste most of it. */
+  if(hugePages && bytes + HEADERSIZE >= HUGEPAGESIZE){
+    length = roundUp(bytes + HEADERSIZE, HUGEPAGESIZE);
+    header = (struct header *) mapHuge(length, &backing);
+  }
+  if(! header){
+    backing = BACKING_MALLOC;
+    length = 0;
+    header = (struct header *) malloc(bytes + HEADERSIZE);
+    assert(header);
+  }
+  header->backing = backing;
+  header->bytes = bytes;
+  header->length = length;
+  return (char *) header + HEADERSIZE;
+}
+
+void *hugeCalloc(size_t bytes){
+  void *block = hugeAlloc(bytes);
+  /* Fresh mappings are already zero. */
+  if(hugeBacking(block) == BACKING_MALLOC){
+    memset(block, 0, bytes);
+  }
+  return block;
+}
+
+void *hugeRealloc(void *block, size_t bytes){
+  struct header *header;
+  void *moved;
+  if(! block){
+    return hugeAlloc(bytes);
+  }
+  header = (struct header *) ((char *) block - HEADERSIZE);
+  if(header->backing != BACKING_MALLOC &&
+    bytes + HEADERSIZE <= header->length){
+    /* Still fits in the pages mapped. */
+    header->bytes = bytes;
+    return block;
+  }
+  if(header->backing == BACKING_MALLOC &&
+    (! hugePages || bytes + HEADERSIZE < HUGEPAGESIZE)){
+    header = (struct header *) realloc(header, bytes + HEADERSIZE);
+    assert(header);
+    header->bytes = bytes;
+    return (char *) header + HEADERSIZE;
+  }
+  moved = hugeAlloc(bytes);
+  memcpy(moved, block, header->bytes < bytes ? header->bytes : bytes);
+  hugeFree(block);
+  return moved;
+}
+
+void hugeFree(void *block){
+  struct header *header;
+  if(! block){
+    return;
+  }
+  header = (struct header *) ((char *) block - HEADERSIZE);
+  if(header->backing == BACKING_MALLOC){
+    free(header);
+  } else {
+    munmap(header, header->length);
+  }
+}
+
+enum backing hugeBacking(void *block){
+  return ((struct header *) ((char *) block - HEADERSIZE))->backing;
+}
+
+struct arena *newArena(size_t bytes){
+  struct arena *arena = (struct arena *) malloc(sizeof(struct arena));
+  assert(arena);
+  arena->bytes = bytes;
+  arena->used = 0;
+  arena->block = (char *) hugeAlloc(bytes);
+  return arena;
+}
+
+void *arenaAlloc(struct arena *arena, size_t bytes){
+  void *buffer = arena->block + arena->used;
+  arena->used += roundUp(bytes, ARENAALIGN);
+  assert(arena->used <= arena->bytes);
+  return buffer;
+}
+
+enum backing arenaBacking(struct arena *arena){
+  return hugeBacking(arena->block);
+}
+
+void freeArena(struct arena *arena){
+  if(! arena){
+    return;
+  }
+  hugeFree(arena->block);
+  free(arena);
+}
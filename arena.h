@@ -0,0 +1,61 @@
+/*
+arena.h
+
+Visible structs and functions for memory backed by 2 MB huge pages.
+
+Large blocks are mapped with MAP_HUGETLB where the system has huge pages set
+  aside, otherwise they are mapped on a 2 MB boundary and the kernel is asked
+  to back them with transparent huge pages. Small blocks, and every block once
+  huge pages are turned off, come from malloc.
+*/
+#include <stddef.h>
+
+/* Prefetches the memory at address into the cache ahead of its use. */
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
+/* How a block of memory was found. */
+#ifndef BACKING_ENUM
+#define BACKING_ENUM
+enum backing {
+  BACKING_MALLOC=0,
+  BACKING_HUGETLB=1,
+  BACKING_TRANSPARENT=2
+};
+#endif
+
+/* A single block which smaller buffers are carved from, all freed together. */
+struct arena;
+
+/* Turns huge pages on (the default) or off for blocks allocated from now on. */
+void useHugePages(int enabled);
+
+/* Allocates bytes of memory, huge page backed if large enough. */
+void *hugeAlloc(size_t bytes);
+
+/* As hugeAlloc, with the memory set to zero. */
+void *hugeCalloc(size_t bytes);
+
+/* Resizes a block from hugeAlloc (or NULL) to bytes, keeping its contents. */
+void *hugeRealloc(void *block, size_t bytes);
+
+/* Frees a block from hugeAlloc, NULL is ignored. */
+void hugeFree(void *block);
+
+/* Returns how a block from hugeAlloc was found. */
+enum backing hugeBacking(void *block);
+
+/* Gets a new arena with room for bytes of buffers. */
+struct arena *newArena(size_t bytes);
+
+/* Takes bytes from the arena, which must have room for them. */
+void *arenaAlloc(struct arena *arena, size_t bytes);
+
+/* Returns how the arena's block was found. */
+enum backing arenaBacking(struct arena *arena);
+
+/* Frees the arena and every buffer taken from it. */
+void freeArena(struct arena *arena);
@@ -0,0 +1,270 @@
+/*
+centrality.c
+
+Betweenness centrality
+
+Implementations for Brandes' algorithm over breadth first searches, with the
+sources split between threads.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include "graph.h"
+#include "arena.h"
+#include "centrality.h"
+
+/* Scores this close (relative to their size) are treated as tied, so rounding
+  in the order the totals were added doesn't change the ranking. */
+#define TIETOLERANCE 1e-9
+/* How many servers ahead in the search order to prefetch rows for. */
+#define PREFETCHDISTANCE 4
+
+/* One thread's share of the sources, and its own scratch space. */
+struct centralityThread {
+  pthread_t thread;
+  struct adjacency *adj;
+  int numServers;
+  int *outageMask;
+  /* Sources first, first + step, ... of sources[] are this thread's. */
+  int *sources;
+  int numSources;
+  int first;
+  int step;
+  /* Dependencies added up over this thread's sources. */
+  double *total;
+  int *dist;
+  double *paths;
+  double *dependency;
+  int *order;
+  /* Set for a server once it has been counted from the one at order[head],
+    to head + 1 while counting paths and -(head + 1) while passing
+    dependencies back, so repeated connections only count once. */
+  int *counted;
+};
+
+static int survives(struct centralityThread *t, int v){
+  return v < t->numServers && ! (t->outageMask && (t->outageMask)[v]);
+}
+
+/* Adds the dependency of every other server on source to the thread's
+  totals, leaving the scratch space as it was found. */
+static void addDependencies(struct centralityThread *t, int source){
+  struct adjacency *adj = t->adj;
+  int *dist = t->dist, *order = t->order, *counted = t->counted;
+  double *paths = t->paths, *dependency = t->dependency;
+  int head, tail = 0, k, u, w;
+
+  /* Count the shortest paths to every server, in order of distance. */
+  dist[source] = 0;
+  paths[source] = 1;
+  order[tail++] = source;
+  for(head = 0; head < tail; head++){
+    u = order[head];
+    if(head + PREFETCHDISTANCE < tail){
+      PREFETCH(&(adj->start)[order[head + PREFETCHDISTANCE]]);
+    }
+    for(k = (adj->start)[u]; k < (adj->start)[u] + (adj->len)[u]; k++){
+      w = (adj->target)[k];
+      if(! survives(t, w) || counted[w] == head + 1) continue;
+      counted[w] = head + 1;
+      if(dist[w] == NOPATH){
+        dist[w] = dist[u] + 1;
+        order[tail++] = w;
+      }
+      if(dist[w] == dist[u] + 1){
+        paths[w] += paths[u];
+      }
+    }
+  }
+
+  /* Pass each server's dependency back to the servers before it, furthest
+    first. */
+  for(head = tail - 1; head >= 0; head--){
+    w = order[head];
+    for(k = (adj->start)[w]; k < (adj->start)[w] + (adj->len)[w]; k++){
+      u = (adj->target)[k];
+      if(! survives(t, u) || counted[u] == -(head + 1)) continue;
+      counted[u] = -(head + 1);
+      if(dist[u] == dist[w] - 1){
+        dependency[u] += paths[u] / paths[w] * (1 + dependency[w]);
+      }
+    }
+    if(w != source){
+      (t->total)[w] += dependency[w];
+    }
+  }
+
+  for(head = 0; head < tail; head++){
+    w = order[head];
+    dist[w] = NOPATH;
+    paths[w] = 0;
+    dependency[w] = 0;
+    counted[w] = 0;
+  }
+}
+
+static void *centralityWorker(void *arg){
+  struct centralityThread *t = (struct centralityThread *) arg;
+  int i;
+  for(i = t->first; i < t->numSources; i += t->step){
+    addDependencies(t, (t->sources)[i]);
+  }
+  return NULL;
+}
+
+/* Picks samples of the count servers in candidates, leaving them sorted at
+  the front. */
+static void sampleSources(int candidates[], int count, int samples,
+  unsigned int seed){
+  unsigned long long state = seed ? seed : 1;
+  int i, j, swap;
+  for(i = 0; i < samples; i++){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    j = i + (int) (state % (unsigned long long) (count - i));
+    swap = candidates[i];
+    candidates[i] = candidates[j];
+    candidates[j] = swap;
+  }
+  qsort(candidates, samples, sizeof(int), cmpfunc);
+}
+
+struct centrality *getBetweenness(struct graph *g, int numServers,
+  int outageMask[], int samples, int numThreads, unsigned int seed){
+  struct centrality *c = (struct centrality *)
+    malloc(sizeof(struct centrality));
+  assert(c);
+  /* Built before the threads start, as they only read it. */
+  struct adjacency *adj = getAdjacency(g);
+  int i, v, numSources = 0;
+  double scale, range;
+
+  c->numServers = numServers;
+  c->score = (double *) malloc(sizeof(double) * (numServers + 1));
+  assert(c->score);
+  int *sources = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(sources);
+  for(v = 0; v < numServers; v++){
+    if(outageMask && outageMask[v]){
+      (c->score)[v] = -1;
+    } else {
+      (c->score)[v] = 0;
+      sources[numSources++] = v;
+    }
+  }
+  c->survivors = numSources;
+  c->errorBound = 0;
+  if(samples > 0 && samples < numSources){
+    sampleSources(sources, numSources, samples, seed);
+    numSources = samples;
+  }
+  c->sources = numSources;
+
+  if(numThreads > numSources){
+    numThreads = numSources;
+  }
+  if(numThreads < 1){
+    numThreads = 1;
+  }
+  struct centralityThread *threads = (struct centralityThread *)
+    malloc(sizeof(struct centralityThread) * numThreads);
+  assert(threads);
+  for(i = 0; i < numThreads; i++){
+    threads[i].adj = adj;
+    threads[i].numServers = numServers;
+    threads[i].outageMask = outageMask;
+    threads[i].sources = sources;
+    threads[i].numSources = numSources;
+    threads[i].first = i;
+    threads[i].step = numThreads;
+    threads[i].total = (double *) calloc(numServers + 1, sizeof(double));
+    assert(threads[i].total);
+    threads[i].paths = (double *) calloc(numServers + 1, sizeof(double));
+    assert(threads[i].paths);
+    threads[i].dependency = (double *) calloc(numServers + 1, sizeof(double));
+    assert(threads[i].dependency);
+    threads[i].dist = (int *) malloc(sizeof(int) * (numServers + 1));
+    assert(threads[i].dist);
+    threads[i].order = (int *) malloc(sizeof(int) * (numServers + 1));
+    assert(threads[i].order);
+    threads[i].counted = (int *) calloc(numServers + 1, sizeof(int));
+    assert(threads[i].counted);
+    for(v = 0; v <= numServers; v++){
+      (threads[i].dist)[v] = NOPATH;
+    }
+    assert(pthread_create(&(threads[i].thread), NULL, centralityWorker,
+      &(threads[i])) == 0);
+  }
+
+  /* Every pair is counted from both ends when every survivor is a source. */
+  scale = 0.5;
+  if(numSources < c->survivors){
+    scale = 0.5 * c->survivors / numSources;
+    /* Hoeffding's inequality over every server at once: each source's
+      dependency is between 0 and survivors - 2. */
+    range = c->survivors > 2 ? c->survivors - 2 : 0;
+    c->errorBound = scale * numSources * range *
+      sqrt(log(2.0 * c->survivors / (1 - CENTRALITYCONFIDENCE)) /
+      (2.0 * numSources));
+  }
+  for(i = 0; i < numThreads; i++){
+    assert(pthread_join(threads[i].thread, NULL) == 0);
+    for(v = 0; v < numServers; v++){
+      if((c->score)[v] >= 0){
+        (c->score)[v] += (threads[i].total)[v];
+      }
+    }
+    free(threads[i].total);
+    free(threads[i].paths);
+    free(threads[i].dependency);
+    free(threads[i].dist);
+    free(threads[i].order);
+    free(threads[i].counted);
+  }
+  for(v = 0; v < numServers; v++){
+    if((c->score)[v] > 0){
+      (c->score)[v] *= scale;
+    }
+  }
+  free(threads);
+  free(sources);
+  return c;
+}
+
+/* Returns 1 if server a should be ranked before server b. */
+static int ranksBefore(struct centrality *c, int a, int b){
+  double x = (c->score)[a], y = (c->score)[b];
+  double tolerance = TIETOLERANCE * (fabs(x) > 1 ? fabs(x) : 1);
+  if(fabs(x - y) <= tolerance){
+    return a < b;
+  }
+  return x > y;
+}
+
+int topCentral(struct centrality *c, int k, int top[]){
+  int v, i, count = 0;
+  /* Insertion into the top k as each server is looked at. */
+  for(v = 0; v < c->numServers; v++){
+    if((c->score)[v] < 0) continue;
+    if(count == k && (k == 0 || ! ranksBefore(c, v, top[k - 1]))) continue;
+    i = count < k ? count++ : k - 1;
+    while(i > 0 && ranksBefore(c, v, top[i - 1])){
+      top[i] = top[i - 1];
+      i--;
+    }
+    top[i] = v;
+  }
+  return count;
+}
+
+void freeCentrality(struct centrality *c){
+  if(! c){
+    return;
+  }
+  free(c->score);
+  free(c);
+}
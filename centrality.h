@@ -0,0 +1,50 @@
+/*
+centrality.h
+
+Visible structs and functions for betweenness centrality: how many shortest
+paths between other pairs of servers pass through each server.
+
+Brandes' algorithm runs a breadth first search from each source and adds up
+  the dependencies of the other servers on paths from it. The sources are
+  split between threads, each with its own scratch space and totals which are
+  added together at the end. Given a number of samples, only that many
+  sources picked at random are searched from and the totals scaled up.
+*/
+/* Because we use struct graph in this file, we should include graph.h here. */
+#include "graph.h"
+
+/* Confidence that every sampled score is within the error bound. */
+#define CENTRALITYCONFIDENCE 0.95
+
+/* The betweenness of every server. */
+#ifndef CENTRALITY_STRUCT
+#define CENTRALITY_STRUCT
+struct centrality {
+  int numServers;
+  /* Per server, the number of shortest paths between pairs of other servers
+    through it, with paths split between equally short ones. -1 for servers
+    affected by the outage. */
+  double *score;
+  /* Servers searched from, and how many could have been. */
+  int sources;
+  int survivors;
+  /* With CENTRALITYCONFIDENCE, every score is within errorBound of its exact
+    value. 0 when every survivor was a source. */
+  double errorBound;
+};
+#endif
+
+/* Finds the betweenness of every server not in outageMask (which may be
+  NULL) using numThreads threads. Searches from every server if samples is 0
+  or at least the number of survivors, otherwise from samples servers picked
+  with the given seed. */
+struct centrality *getBetweenness(struct graph *g, int numServers,
+  int outageMask[], int samples, int numThreads, unsigned int seed);
+
+/* Fills top[] with up to k of the surviving servers with the highest
+  betweenness, highest first and ties going to the smaller server. Returns the
+  number filled in. */
+int topCentral(struct centrality *c, int k, int top[]);
+
+/* Frees all memory used by c. */
+void freeCentrality(struct centrality *c);
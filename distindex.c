@@ -0,0 +1,456 @@
+/*
+distindex.c
+
+Point to point distance index
+
+Implementations for building a pruned landmark labelling and answering
+distance and path queries from it, or from a breadth first search from both
+ends when the outage is different.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include "graph.h"
+#include "distindex.h"
+
+/* Hub rank ending every server's labels, larger than any real rank. */
+#define LASTLABEL INT_MAX
+
+/* The distance from a server to a hub, and the next server towards it. */
+struct label {
+  int hub;
+  int dist;
+  int parent;
+};
+
+/* One server's labels while the index is being built. */
+struct labelList {
+  int count;
+  int allocated;
+  struct label *labels;
+};
+
+struct distanceIndex {
+  struct graph *g;
+  struct adjacency *adj;
+  int numServers;
+  /* Servers left out of the index, and how many of them weren't
+    decommissioned. */
+  int *down;
+  int outageCount;
+  /* Hubs are numbered by rank, servers with the most connections first. */
+  int *byRank;
+  /* Labels of server v are labels[labelStart[v]] onwards, in increasing order
+    of hub and ending with LASTLABEL. */
+  long long *labelStart;
+  struct label *labels;
+  long long numLabels;
+  /* Scratch space for queries. Servers in the query's outage are marked with
+    the current stamp. */
+  unsigned int stamp;
+  unsigned int *queryMask;
+  int *distA;
+  int *distB;
+  int *prevA;
+  int *prevB;
+  int *queueA;
+  int *queueB;
+};
+
+static void addLabel(struct labelList *list, int hub, int dist, int parent){
+  if(list->count == list->allocated){
+    list->allocated = list->allocated > 0 ? 2 * list->allocated : 4;
+    list->labels = (struct label *) realloc(list->labels,
+      sizeof(struct label) * list->allocated);
+    assert(list->labels);
+  }
+  (list->labels)[list->count].hub = hub;
+  (list->labels)[list->count].dist = dist;
+  (list->labels)[list->count].parent = parent;
+  list->count++;
+}
+
+/* Ranks the servers left by number of surviving connections, most first and
+  ties going to the smaller server, with a counting sort. Returns the number
+  ranked. */
+static int rankServers(struct distanceIndex *index){
+  struct adjacency *adj = index->adj;
+  int n = index->numServers;
+  int *degree = (int *) calloc(n + 1, sizeof(int));
+  assert(degree);
+  int *first = (int *) calloc(n + 2, sizeof(int));
+  assert(first);
+  int v, k, w, count = 0;
+  for(v = 0; v < n; v++){
+    if((index->down)[v]) continue;
+    for(k = (adj->start)[v]; k < (adj->start)[v] + (adj->len)[v]; k++){
+      w = (adj->target)[k];
+      if(w < n && ! (index->down)[w]){
+        degree[v]++;
+      }
+    }
+    /* Repeated connections can count more than n, which sorts the same. */
+    if(degree[v] > n){
+      degree[v] = n;
+    }
+    /* Counted from the top, so the largest degrees come first. */
+    first[n - degree[v] + 1]++;
+    count++;
+  }
+  for(v = 1; v <= n + 1; v++){
+    first[v] += first[v - 1];
+  }
+  for(v = 0; v < n; v++){
+    if((index->down)[v]) continue;
+    (index->byRank)[first[n - degree[v]]++] = v;
+  }
+  free(degree);
+  free(first);
+  return count;
+}
+
+/* Adds a label for hub rootRank to every server whose distance to root isn't
+  already given by their labels, searching on only from those servers. */
+static void prunedSearch(struct distanceIndex *index, struct labelList lists[],
+  int rootRank, int rootDist[], int dist[], int parent[], int queue[]){
+  struct adjacency *adj = index->adj;
+  int root = (index->byRank)[rootRank];
+  struct labelList *rootList = &(lists[root]);
+  struct label *l;
+  int head, tail = 0, i, k, u, w, d, pruned;
+
+  for(i = 0; i < rootList->count; i++){
+    rootDist[(rootList->labels)[i].hub] = (rootList->labels)[i].dist;
+  }
+  dist[root] = 0;
+  parent[root] = root;
+  queue[tail++] = root;
+  for(head = 0; head < tail; head++){
+    u = queue[head];
+    d = dist[u];
+    pruned = 0;
+    for(i = 0; i < lists[u].count; i++){
+      l = &((lists[u].labels)[i]);
+      if(rootDist[l->hub] != NOPATH && rootDist[l->hub] + l->dist <= d){
+        pruned = 1;
+        break;
+      }
+    }
+    if(pruned) continue;
+    addLabel(&(lists[u]), rootRank, d, parent[u]);
+    for(k = (adj->start)[u]; k < (adj->start)[u] + (adj->len)[u]; k++){
+      w = (adj->target)[k];
+      if(w >= index->numServers || (index->down)[w] || dist[w] != NOPATH){
+        continue;
+      }
+      dist[w] = d + 1;
+      parent[w] = u;
+      queue[tail++] = w;
+    }
+  }
+
+  for(head = 0; head < tail; head++){
+    dist[queue[head]] = NOPATH;
+  }
+  for(i = 0; i < rootList->count; i++){
+    rootDist[(rootList->labels)[i].hub] = NOPATH;
+  }
+}
+
+struct distanceIndex *buildDistanceIndex(struct graph *g, int numServers,
+  int outageMask[]){
+  struct distanceIndex *index = (struct distanceIndex *)
+    malloc(sizeof(struct distanceIndex));
+  assert(index);
+  int i, v, ranked, size = numServers + 1;
+  long long next;
+
+  index->g = g;
+  index->adj = getAdjacency(g);
+  index->numServers = numServers;
+  index->down = (int *) calloc(size, sizeof(int));
+  assert(index->down);
+  index->outageCount = 0;
+  for(v = 0; v < numServers; v++){
+    if(isRemoved(g, v)){
+      (index->down)[v] = 1;
+    } else if(outageMask && outageMask[v]){
+      (index->down)[v] = 1;
+      index->outageCount++;
+    }
+  }
+  index->byRank = (int *) malloc(sizeof(int) * size);
+  assert(index->byRank);
+  ranked = rankServers(index);
+
+  /* Search from each hub in order of rank, so every server's labels are
+    added in increasing order of hub. */
+  struct labelList *lists = (struct labelList *)
+    calloc(size, sizeof(struct labelList));
+  assert(lists);
+  int *rootDist = (int *) malloc(sizeof(int) * size);
+  assert(rootDist);
+  int *dist = (int *) malloc(sizeof(int) * size);
+  assert(dist);
+  int *parent = (int *) malloc(sizeof(int) * size);
+  assert(parent);
+  int *queue = (int *) malloc(sizeof(int) * size);
+  assert(queue);
+  for(v = 0; v < size; v++){
+    rootDist[v] = NOPATH;
+    dist[v] = NOPATH;
+  }
+  for(i = 0; i < ranked; i++){
+    prunedSearch(index, lists, i, rootDist, dist, parent, queue);
+  }
+  free(rootDist);
+
+  /* Pack the labels into one array. */
+  index->numLabels = 0;
+  for(v = 0; v < numServers; v++){
+    index->numLabels += lists[v].count;
+  }
+  index->labels = (struct label *)
+    malloc(sizeof(struct label) * (index->numLabels + numServers + 1));
+  assert(index->labels);
+  index->labelStart = (long long *) malloc(sizeof(long long) * size);
+  assert(index->labelStart);
+  next = 0;
+  for(v = 0; v < numServers; v++){
+    (index->labelStart)[v] = next;
+    if(lists[v].count > 0){
+      memcpy(&((index->labels)[next]), lists[v].labels,
+        sizeof(struct label) * lists[v].count);
+      next += lists[v].count;
+    }
+    (index->labels)[next].hub = LASTLABEL;
+    (index->labels)[next].dist = NOPATH;
+    (index->labels)[next].parent = -1;
+    next++;
+    free(lists[v].labels);
+  }
+  (index->labelStart)[numServers] = next;
+  free(lists);
+
+  /* The build's scratch space is kept for queries. */
+  index->stamp = 0;
+  index->queryMask = (unsigned int *) calloc(size, sizeof(unsigned int));
+  assert(index->queryMask);
+  index->distA = dist;
+  index->prevA = parent;
+  index->queueA = queue;
+  index->distB = (int *) malloc(sizeof(int) * size);
+  assert(index->distB);
+  index->prevB = (int *) malloc(sizeof(int) * size);
+  assert(index->prevB);
+  index->queueB = (int *) malloc(sizeof(int) * size);
+  assert(index->queueB);
+  for(v = 0; v < size; v++){
+    (index->distB)[v] = NOPATH;
+  }
+  return index;
+}
+
+/* Returns server v's label for hub, which must exist. */
+static struct label *findLabel(struct distanceIndex *index, int v, int hub){
+  /* The last label is LASTLABEL, so isn't searched. */
+  long long low = (index->labelStart)[v];
+  long long high = (index->labelStart)[v + 1] - 2;
+  long long middle;
+  while(low < high){
+    middle = low + (high - low) / 2;
+    if((index->labels)[middle].hub < hub){
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  assert((index->labels)[low].hub == hub);
+  return &((index->labels)[low]);
+}
+
+/* Answers a query from the labels alone. */
+static int labelDistance(struct distanceIndex *index, int a, int b,
+  int path[]){
+  struct label *x = &((index->labels)[(index->labelStart)[a]]);
+  struct label *y = &((index->labels)[(index->labelStart)[b]]);
+  int best = NOPATH, hub = -1, toHub = 0, i, v;
+  while(x->hub != LASTLABEL && y->hub != LASTLABEL){
+    if(x->hub < y->hub){
+      x++;
+    } else if(x->hub > y->hub){
+      y++;
+    } else {
+      if(x->dist + y->dist < best){
+        best = x->dist + y->dist;
+        hub = x->hub;
+        toHub = x->dist;
+      }
+      x++;
+      y++;
+    }
+  }
+  if(best == NOPATH || ! path){
+    return best;
+  }
+  /* Walk from a to the hub, then from b back to it, filling from the end. */
+  v = a;
+  for(i = 0; i <= toHub; i++){
+    path[i] = v;
+    v = findLabel(index, v, hub)->parent;
+  }
+  v = b;
+  for(i = best; i > toHub; i--){
+    path[i] = v;
+    v = findLabel(index, v, hub)->parent;
+  }
+  return best;
+}
+
+/* Marks the servers in outageSIDs with a new stamp, returning 1 if they are
+  the servers the index was built without. */
+static int markOutage(struct distanceIndex *index, int outageCount,
+  int outageSIDs[]){
+  int i, v, distinct = 0, same = 1;
+  index->stamp++;
+  if(index->stamp == 0){
+    memset(index->queryMask, 0,
+      sizeof(unsigned int) * (index->numServers + 1));
+    index->stamp = 1;
+  }
+  for(i = 0; i < outageCount; i++){
+    v = outageSIDs[i];
+    if(v < 0 || v >= index->numServers || (index->queryMask)[v] ==
+      index->stamp) continue;
+    (index->queryMask)[v] = index->stamp;
+    if(isRemoved(index->g, v)) continue;
+    distinct++;
+    if(! (index->down)[v]){
+      same = 0;
+    }
+  }
+  return same && distinct == index->outageCount;
+}
+
+static int searchSkips(struct distanceIndex *index, int v){
+  return v >= index->numServers || (index->queryMask)[v] == index->stamp ||
+    isRemoved(index->g, v);
+}
+
+/* Answers a query with a breadth first search from both ends, a whole level
+  of the side with the smaller frontier at a time, skipping the servers
+  marked by markOutage. */
+static int searchDistance(struct distanceIndex *index, int a, int b,
+  int path[]){
+  struct adjacency *adj = index->adj;
+  int *distA = index->distA, *distB = index->distB;
+  int *prevA = index->prevA, *prevB = index->prevB;
+  int *queueA = index->queueA, *queueB = index->queueB;
+  int headA = 0, tailA = 0, headB = 0, tailB = 0;
+  int best = NOPATH, meetA = -1, meetB = -1;
+  int *mine, *other, *prev, *queue, *head, *tail;
+  int end, k, u, w, i, v, fromA;
+
+  distA[a] = 0;
+  queueA[tailA++] = a;
+  distB[b] = 0;
+  queueB[tailB++] = b;
+  if(a == b){
+    best = 0;
+    meetA = meetB = a;
+  }
+  while(best == NOPATH && headA < tailA && headB < tailB){
+    fromA = tailA - headA <= tailB - headB;
+    if(fromA){
+      mine = distA; other = distB; prev = prevA; queue = queueA;
+      head = &headA; tail = &tailA;
+    } else {
+      mine = distB; other = distA; prev = prevB; queue = queueB;
+      head = &headB; tail = &tailB;
+    }
+    /* A meeting found partway through the level may not be the shortest, so
+      the whole level is searched. */
+    for(end = *tail; *head < end; (*head)++){
+      u = queue[*head];
+      for(k = (adj->start)[u]; k < (adj->start)[u] + (adj->len)[u]; k++){
+        w = (adj->target)[k];
+        if(searchSkips(index, w)) continue;
+        if(other[w] != NOPATH && mine[u] + 1 + other[w] < best){
+          best = mine[u] + 1 + other[w];
+          meetA = fromA ? u : w;
+          meetB = fromA ? w : u;
+        }
+        if(mine[w] == NOPATH){
+          mine[w] = mine[u] + 1;
+          prev[w] = u;
+          queue[(*tail)++] = w;
+        }
+      }
+    }
+  }
+
+  if(best != NOPATH && path){
+    /* meetA is distA[meetA] steps from a, and meetB is the next server. */
+    v = meetA;
+    for(i = distA[meetA]; i >= 0; i--){
+      path[i] = v;
+      v = prevA[v];
+    }
+    v = meetB;
+    for(i = best - distB[meetB]; i <= best; i++){
+      path[i] = v;
+      v = prevB[v];
+    }
+  }
+  for(i = 0; i < tailA; i++){
+    distA[queueA[i]] = NOPATH;
+  }
+  for(i = 0; i < tailB; i++){
+    distB[queueB[i]] = NOPATH;
+  }
+  return best;
+}
+
+int queryDistance(struct distanceIndex *index, int outageCount,
+  int outageSIDs[], int a, int b, int path[]){
+  assert(a >= 0 && a < index->numServers);
+  assert(b >= 0 && b < index->numServers);
+  if(! outageSIDs || markOutage(index, outageCount, outageSIDs)){
+    if((index->down)[a] || (index->down)[b]){
+      return NOPATH;
+    }
+    return labelDistance(index, a, b, path);
+  }
+  if(searchSkips(index, a) || searchSkips(index, b)){
+    return NOPATH;
+  }
+  return searchDistance(index, a, b, path);
+}
+
+long long distanceIndexLabels(struct distanceIndex *index){
+  return index->numLabels;
+}
+
+int distanceIndexServers(struct distanceIndex *index){
+  return index->numServers;
+}
+
+void freeDistanceIndex(struct distanceIndex *index){
+  if(! index){
+    return;
+  }
+  free(index->down);
+  free(index->byRank);
+  free(index->labelStart);
+  free(index->labels);
+  free(index->queryMask);
+  free(index->distA);
+  free(index->distB);
+  free(index->prevA);
+  free(index->prevB);
+  free(index->queueA);
+  free(index->queueB);
+  free(index);
+}
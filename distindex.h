@@ -0,0 +1,47 @@
+/*
+distindex.h
+
+Visible structs and functions for a point to point distance index: the number
+of hops, and a shortest path, between any two servers after the outage
+without a traversal of the network.
+
+The index is a pruned landmark labelling. Servers are ranked by degree and a
+  breadth first search is run from each in turn, giving every server it
+  reaches a label with the distance back to it, unless the labels already
+  added give that distance or less. The shortest distance between two servers
+  is then the smallest total over the hubs their labels share. Each label also
+  keeps the server one step closer to its hub, so paths can be walked out.
+
+Queries for a different outage fall back to a breadth first search from both
+  ends at once, skipping the servers in that outage.
+*/
+/* Because we use struct graph in this file, we should include graph.h here. */
+#include "graph.h"
+
+/* The labels of every server and the outage they were built for. */
+struct distanceIndex;
+
+/* Builds the index for the network of numServers servers with the servers in
+  outageMask (which may be NULL) left out. The index is only valid until the
+  graph is next changed. */
+struct distanceIndex *buildDistanceIndex(struct graph *g, int numServers,
+  int outageMask[]);
+
+/* Returns the number of hops between servers a and b, or NOPATH if either is
+  in the outage or they are in different subnetworks. If outageSIDs is NULL or
+  lists the outage the index was built for, the labels are used, otherwise a
+  search from both ends skips the outageCount servers in outageSIDs. If path
+  is not NULL it is filled with the servers on a shortest path, a first and b
+  last, so needs room for every server. Queries share scratch space in the
+  index, so only one thread may query at a time. */
+int queryDistance(struct distanceIndex *index, int outageCount,
+  int outageSIDs[], int a, int b, int path[]);
+
+/* Returns the number of labels in the index. */
+long long distanceIndexLabels(struct distanceIndex *index);
+
+/* Returns the number of servers in the network the index was built for. */
+int distanceIndexServers(struct distanceIndex *index);
+
+/* Frees all memory used by index. */
+void freeDistanceIndex(struct distanceIndex *index);
@@ -0,0 +1,503 @@
+/*
+extgraph.c
+
+Semi-external graph implementation.
+
+Implementations for helper functions for answering questions about a network
+file without reading its connections into memory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "graph.h"
+#include "extgraph.h"
+
+/* Smallest buffer used for reading the network file. */
+#define MINBUFFER 4096
+/* Largest buffer used for reading the network file. */
+#define MAXREADBUFFER (1 << 20)
+#define UNVISITED 0
+#define VISITED 1
+
+/* Per server arrays are allocated rather than placed on the stack, as the
+  number of servers may be large. */
+static void *allocServers(int n, size_t itemSize){
+  void *items = malloc(itemSize * (n > 0 ? n : 1));
+  assert(items);
+  return items;
+}
+
+struct extGraph {
+  FILE *networkFile;
+  int numServers;
+  int numConnections;
+  /* Where the first connection starts in the file. */
+  long connectionsStart;
+  size_t memoryBudget;
+  int passes;
+  /* Chunk of the network file being parsed. */
+  char *buffer;
+  size_t bufferSize;
+  size_t bufferUsed;
+  size_t bufferPos;
+};
+
+struct extGraph *openExtGraph(const char *networkPath, size_t memoryBudget){
+  struct extGraph *eg = (struct extGraph *) malloc(sizeof(struct extGraph));
+  assert(eg);
+  eg->networkFile = fopen(networkPath, "r");
+  assert(eg->networkFile);
+  /* First line comprises number of servers and number of connections. */
+  assert(fscanf(eg->networkFile, "%d %d", &(eg->numServers),
+    &(eg->numConnections)) == 2);
+  eg->connectionsStart = ftell(eg->networkFile);
+  assert(eg->connectionsStart >= 0);
+
+  if(memoryBudget < 2 * MINBUFFER){
+    memoryBudget = 2 * MINBUFFER;
+  }
+  eg->memoryBudget = memoryBudget;
+  eg->passes = 0;
+  /* Spend at most a quarter of the budget on reading the file. */
+  eg->bufferSize = memoryBudget / 4;
+  if(eg->bufferSize < MINBUFFER){
+    eg->bufferSize = MINBUFFER;
+  }
+  if(eg->bufferSize > MAXREADBUFFER){
+    eg->bufferSize = MAXREADBUFFER;
+  }
+  eg->buffer = (char *) malloc(eg->bufferSize);
+  assert(eg->buffer);
+  eg->bufferUsed = 0;
+  eg->bufferPos = 0;
+  return eg;
+}
+
+void freeExtGraph(struct extGraph *eg){
+  if(! eg){
+    return;
+  }
+  assert(fclose(eg->networkFile) == 0);
+  free(eg->buffer);
+  free(eg);
+}
+
+int extGraphPasses(struct extGraph *eg){
+  return eg->passes;
+}
+
+/* Starts a new pass over the connections in the file. */
+static void rewindConnections(struct extGraph *eg){
+  assert(fseek(eg->networkFile, eg->connectionsStart, SEEK_SET) == 0);
+  eg->bufferUsed = 0;
+  eg->bufferPos = 0;
+  (eg->passes)++;
+}
+
+/* Returns the next character of the file, refilling the buffer a chunk at a
+  time, or EOF at the end of the file. */
+static int nextChar(struct extGraph *eg){
+  if(eg->bufferPos == eg->bufferUsed){
+    eg->bufferUsed = fread(eg->buffer, 1, eg->bufferSize, eg->networkFile);
+    eg->bufferPos = 0;
+    if(eg->bufferUsed == 0){
+      return EOF;
+    }
+  }
+  return (unsigned char) (eg->buffer)[(eg->bufferPos)++];
+}
+
+/* Reads the next number on the current line into *value. Returns 1 if one
+  was read, 0 if the line (or file) ended first. */
+static int nextNumber(struct extGraph *eg, int *value){
+  int c, sign = 1, seen = 0;
+  long result = 0;
+  do {
+    c = nextChar(eg);
+  } while(c == ' ' || c == '\t' || c == '\r');
+  if(c == '-'){
+    sign = -1;
+    c = nextChar(eg);
+  }
+  while(c >= '0' && c <= '9'){
+    result = result * 10 + (c - '0');
+    seen = 1;
+    c = nextChar(eg);
+  }
+  /* Leave a line ending for the next call to find. */
+  if(c == '\n'){
+    (eg->bufferPos)--;
+  }
+  if(! seen){
+    return 0;
+  }
+  *value = (int) (sign * result);
+  return 1;
+}
+
+/* Reads the next connection into *start and *end, skipping its optional cost.
+  Returns 0 once every connection has been read. */
+static int nextConnection(struct extGraph *eg, int *start, int *end){
+  int c, weight;
+  /* Skip to the start of the next line holding a connection. */
+  while(! nextNumber(eg, start)){
+    c = nextChar(eg);
+    if(c == EOF){
+      return 0;
+    }
+  }
+  assert(nextNumber(eg, end));
+  nextNumber(eg, &weight);
+  return 1;
+}
+
+static int findRoot(int parent[], int v){
+  int root = v, next;
+  while(parent[root] != root){
+    root = parent[root];
+  }
+  /* Point everything on the way straight at the root. */
+  while(parent[v] != root){
+    next = parent[v];
+    parent[v] = root;
+    v = next;
+  }
+  return root;
+}
+
+/* Joins the sets of every connection in a single pass over the file, so that
+  findRoot gives each server's subnetwork. Returns the number of subnetworks. */
+static int unionConnections(struct extGraph *eg, int parent[], int size[]){
+  int i, u, v, ru, rv, count = eg->numServers;
+  for(i = 0; i < eg->numServers; i++){
+    parent[i] = i;
+    size[i] = 1;
+  }
+  rewindConnections(eg);
+  for(i = 0; i < eg->numConnections && nextConnection(eg, &u, &v); i++){
+    if(u < 0 || v < 0 || u >= eg->numServers || v >= eg->numServers){
+      continue;
+    }
+    ru = findRoot(parent, u);
+    rv = findRoot(parent, v);
+    if(ru == rv){
+      continue;
+    }
+    /* Join the smaller set into the larger one. */
+    if(size[ru] < size[rv]){
+      parent[ru] = rv;
+      size[rv] += size[ru];
+    } else {
+      parent[rv] = ru;
+      size[ru] += size[rv];
+    }
+    count--;
+  }
+  return count;
+}
+
+/* Fewest connections buffered for each range of servers while they are
+  sorted into ranges. */
+#define MINBUCKETPAIRS 64
+
+/* Writes the (server, neighbour) pairs buffered for one range of servers to
+  the next part of the pair file for that range. */
+static void flushPairs(FILE *pairFile, int pairs[], int *buffered,
+  long long *written){
+  if(*buffered == 0){
+    return;
+  }
+  assert(fseek(pairFile, (long) (*written * 2 * sizeof(int)), SEEK_SET) == 0);
+  assert(fwrite(pairs, sizeof(int), *buffered, pairFile) ==
+    (size_t) *buffered);
+  *written += *buffered / 2;
+  *buffered = 0;
+}
+
+/* Writes the adjacency rows of every server to adjacencyFile, with the row of
+  server v starting at entry offsets[v]. After counting the connections, a
+  single pass over the network file sorts them into ranges of servers, each
+  range's connections going to its own part of a temporary file. Each range is
+  then read back and its rows filled in, a window of the memory budget at a
+  time. */
+static void writeAdjacency(struct extGraph *eg, long long offsets[],
+  FILE *adjacencyFile){
+  int n = eg->numServers, i, u, v, b, numBuckets, maxBuckets, slice;
+  int *fill = (int *) allocServers(n, sizeof(int));
+  long long total, target, entries, low, high, slot, pos, end;
+  size_t rangeSize = eg->memoryBudget - eg->bufferSize;
+  size_t chunkPairs = eg->bufferSize / (2 * sizeof(int)), got, k;
+  rangeSize /= sizeof(int);
+  int *range = (int *) malloc(sizeof(int) * rangeSize);
+  assert(range);
+  /* The read buffer is free once the network file is sorted, so the ranges
+    are read back through it. */
+  int *chunk = (int *) eg->buffer;
+  FILE *pairFile = tmpfile();
+  assert(pairFile);
+
+  /* Count each server's connections, then lay the rows out one after the
+    other. */
+  for(i = 0; i < n; i++){
+    fill[i] = 0;
+  }
+  rewindConnections(eg);
+  for(i = 0; i < eg->numConnections && nextConnection(eg, &u, &v); i++){
+    if(u < 0 || v < 0 || u >= n || v >= n || u == v){
+      continue;
+    }
+    fill[u]++;
+    fill[v]++;
+  }
+  offsets[0] = 0;
+  for(i = 0; i < n; i++){
+    offsets[i + 1] = offsets[i] + fill[i];
+  }
+  total = offsets[n];
+
+  /* Split the servers into ranges whose rows fit in the budget where
+    possible, with few enough ranges that each can buffer its connections. */
+  maxBuckets = (int) (rangeSize / (2 * MINBUCKETPAIRS));
+  if(maxBuckets < 1){
+    maxBuckets = 1;
+  }
+  target = (total + maxBuckets - 1) / maxBuckets;
+  if(target < (long long) rangeSize){
+    target = (long long) rangeSize;
+  }
+  int *bucketStart = (int *) malloc(sizeof(int) * (maxBuckets + 1));
+  assert(bucketStart);
+  numBuckets = 0;
+  entries = 0;
+  for(i = 0; i < n; i++){
+    if(numBuckets == 0 || (entries > 0 && entries + (offsets[i + 1] -
+      offsets[i]) > target && numBuckets < maxBuckets)){
+      bucketStart[numBuckets++] = i;
+      entries = 0;
+    }
+    entries += offsets[i + 1] - offsets[i];
+    /* fill is not needed again until the ranges are read back. */
+    fill[i] = numBuckets - 1;
+  }
+  bucketStart[numBuckets] = n;
+
+  /* The connections of each range go to the same part of the pair file as
+    its rows will take in the adjacency file, each range buffering its
+    connections in its own slice of range[]. */
+  slice = (int) (rangeSize / numBuckets) / 2 * 2;
+  int *buffered = (int *) calloc(numBuckets, sizeof(int));
+  assert(buffered);
+  long long *written = (long long *) malloc(sizeof(long long) * numBuckets);
+  assert(written);
+  for(b = 0; b < numBuckets; b++){
+    written[b] = offsets[bucketStart[b]];
+  }
+  rewindConnections(eg);
+  for(i = 0; i < eg->numConnections && nextConnection(eg, &u, &v); i++){
+    if(u < 0 || v < 0 || u >= n || v >= n || u == v){
+      continue;
+    }
+    b = fill[u];
+    range[b * slice + buffered[b]++] = u;
+    range[b * slice + buffered[b]++] = v;
+    if(buffered[b] == slice){
+      flushPairs(pairFile, &(range[b * slice]), &(buffered[b]), &(written[b]));
+    }
+    b = fill[v];
+    range[b * slice + buffered[b]++] = v;
+    range[b * slice + buffered[b]++] = u;
+    if(buffered[b] == slice){
+      flushPairs(pairFile, &(range[b * slice]), &(buffered[b]), &(written[b]));
+    }
+  }
+  for(b = 0; b < numBuckets; b++){
+    flushPairs(pairFile, &(range[b * slice]), &(buffered[b]), &(written[b]));
+  }
+  assert(fflush(pairFile) == 0);
+
+  /* Fill in each range's rows from its part of the pair file, connections
+    keeping the order they had in the network file. A range with more entries
+    than the budget holds is read once per window of it. */
+  for(b = 0; b < numBuckets; b++){
+    assert(written[b] == offsets[bucketStart[b + 1]]);
+    end = offsets[bucketStart[b + 1]];
+    for(low = offsets[bucketStart[b]]; low < end; low = high){
+      high = low + (long long) rangeSize;
+      if(high > end){
+        high = end;
+      }
+      for(i = bucketStart[b]; i < bucketStart[b + 1]; i++){
+        fill[i] = 0;
+      }
+      pos = offsets[bucketStart[b]];
+      assert(fseek(pairFile, (long) (pos * 2 * sizeof(int)), SEEK_SET) == 0);
+      while(pos < end){
+        got = chunkPairs;
+        if((long long) got > end - pos){
+          got = (size_t) (end - pos);
+        }
+        assert(fread(chunk, 2 * sizeof(int), got, pairFile) == got);
+        for(k = 0; k < got; k++){
+          slot = offsets[chunk[2 * k]] + fill[chunk[2 * k]]++;
+          if(slot >= low && slot < high){
+            range[slot - low] = chunk[2 * k + 1];
+          }
+        }
+        pos += (long long) got;
+      }
+      assert(fwrite(range, sizeof(int), high - low, adjacencyFile) ==
+        (size_t) (high - low));
+    }
+  }
+  assert(fflush(adjacencyFile) == 0);
+  assert(fclose(pairFile) == 0);
+  free(written);
+  free(buffered);
+  free(bucketStart);
+  free(range);
+  free(fill);
+}
+
+/* Finds the critical servers with an iterative depth first search over the
+  adjacency rows in adjacency[], which may be backed by a file on disk. */
+static int findCritical(int n, long long offsets[], const int *adjacency,
+  int iscritical[]){
+  int *order = (int *) allocServers(n, sizeof(int));
+  int *hra = (int *) allocServers(n, sizeof(int));
+  int *parent = (int *) allocServers(n, sizeof(int));
+  int *stack = (int *) allocServers(n, sizeof(int));
+  int *visited = (int *) allocServers(n, sizeof(int));
+  long long *nextedge = (long long *) allocServers(n, sizeof(long long));
+  int i, top, u, v, p, root, children, count = 0, criticalcount = 0;
+
+  for(i = 0; i < n; i++){
+    visited[i] = UNVISITED;
+    iscritical[i] = 0;
+    parent[i] = -1;
+  }
+  for(root = 0; root < n; root++){
+    if(visited[root]){
+      continue;
+    }
+    children = 0;
+    top = 0;
+    visited[root] = VISITED;
+    order[root] = hra[root] = ++count;
+    nextedge[root] = offsets[root];
+    stack[top++] = root;
+    while(top > 0){
+      u = stack[top - 1];
+      if(nextedge[u] < offsets[u + 1]){
+        v = adjacency[(nextedge[u])++];
+        if(! visited[v]){
+          if(u == root){
+            children++;
+          }
+          parent[v] = u;
+          visited[v] = VISITED;
+          order[v] = hra[v] = ++count;
+          nextedge[v] = offsets[v];
+          stack[top++] = v;
+        } else if(v != parent[u]){
+          /* Back edge found. */
+          hra[u] = min(hra[u], order[v]);
+        }
+        continue;
+      }
+      /* All of u's children are done, pass its hra up to its parent. */
+      top--;
+      if(top == 0){
+        break;
+      }
+      p = parent[u];
+      hra[p] = min(hra[p], hra[u]);
+      if(parent[p] != -1 && hra[u] >= order[p] && ! iscritical[p]){
+        iscritical[p] = 1;
+        criticalcount++;
+      }
+    }
+    if(children > 1 && ! iscritical[root]){
+      iscritical[root] = 1;
+      criticalcount++;
+    }
+  }
+  free(order);
+  free(hra);
+  free(parent);
+  free(stack);
+  free(visited);
+  free(nextedge);
+  return criticalcount;
+}
+
+struct solution *extGraphSolve(struct extGraph *eg, enum problemPart part){
+  int n = eg->numServers, i, j;
+  struct solution *solution = (struct solution *)
+    malloc(sizeof(struct solution));
+  assert(solution);
+  initaliseSolution(solution);
+
+  if(part == TASK_2 || part == TASK_3){
+    int *parent = (int *) allocServers(n, sizeof(int));
+    int *size = (int *) allocServers(n, sizeof(int));
+    int root, best = -1;
+    solution->connectedSubnets = unionConnections(eg, parent, size);
+    /* Servers are tried in increasing order, so ties go to the subnetwork
+      with the smaller server. */
+    for(i = 0; part == TASK_3 && i < n; i++){
+      root = findRoot(parent, i);
+      if(best == -1 || size[root] > size[best]){
+        best = root;
+      }
+    }
+    if(best != -1){
+      solution->largestSubnet = size[best];
+      solution->largestSubnetSIDs = (int *) malloc(sizeof(int) * size[best]);
+      assert(solution->largestSubnetSIDs);
+      for(i = 0, j = 0; i < n; i++){
+        if(findRoot(parent, i) == best){
+          (solution->largestSubnetSIDs)[j++] = i;
+        }
+      }
+    }
+    free(parent);
+    free(size);
+  } else if(part == TASK_7){
+    long long *offsets = (long long *) malloc(sizeof(long long) * (n + 1));
+    assert(offsets);
+    int *iscritical = (int *) allocServers(n, sizeof(int));
+    FILE *adjacencyFile = tmpfile();
+    assert(adjacencyFile);
+    writeAdjacency(eg, offsets, adjacencyFile);
+
+    /* Map the adjacency file so the search reads rows through the page cache
+      rather than holding them all. */
+    const int *adjacency = NULL;
+    size_t mappedSize = sizeof(int) * (size_t) offsets[n];
+    if(mappedSize > 0){
+      adjacency = (const int *) mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE,
+        fileno(adjacencyFile), 0);
+      assert(adjacency != MAP_FAILED);
+    }
+    solution->criticalServerCount = findCritical(n, offsets, adjacency,
+      iscritical);
+    if(mappedSize > 0){
+      munmap((void *) adjacency, mappedSize);
+    }
+    assert(fclose(adjacencyFile) == 0);
+    free(offsets);
+
+    solution->criticalServerSIDs = (int *) malloc(sizeof(int) *
+      (solution->criticalServerCount + 1));
+    assert(solution->criticalServerSIDs);
+    for(i = 0, j = 0; i < n; i++){
+      if(iscritical[i]){
+        (solution->criticalServerSIDs)[j++] = i;
+      }
+    }
+    free(iscritical);
+  }
+  return solution;
+}
@@ -0,0 +1,35 @@
+/*
+extgraph.h
+
+Visible structs and functions for semi-external graphs, where only a constant
+amount of information per server is kept in memory and the connections are
+streamed from the network file whenever they are needed.
+*/
+#include <stddef.h>
+/* Because we use struct solution and enum problemPart in this file, we should
+  include graph.h here. */
+#include "graph.h"
+
+/* A network file opened for streaming. */
+struct extGraph;
+
+/* Opens the network file at the given path, reading only its first line.
+  memoryBudget is the number of bytes which may be used for buffering
+  connections, on top of a fixed amount per server. */
+struct extGraph *openExtGraph(const char *networkPath, size_t memoryBudget);
+
+/* Finds the solution for Task 2, Task 3 or Task 7 without holding the
+  connections in memory:
+  - Tasks 2 and 3 use union-find over a single pass of the file.
+  - Task 7 sorts the connections into an adjacency file on disk, with one
+    pass to count them and one to sort them into ranges of servers in a
+    temporary file, then maps that file into memory for the depth first
+    search.
+  */
+struct solution *extGraphSolve(struct extGraph *eg, enum problemPart part);
+
+/* Returns the number of passes made over the network file so far. */
+int extGraphPasses(struct extGraph *eg);
+
+/* Closes the network file and frees all memory used by the graph. */
+void freeExtGraph(struct extGraph *eg);
@@ -14,11 +14,21 @@ Skeleton written by Grady Fitzpatrick for COMP20007 Assignment 1 2021
 #include "graph.h"
 #include "utils.h"
 #include "pq.h"
+#include "mpq.h"
+#include "arena.h"
 
 #define INITIALEDGES 32
+/* Smallest room given to an adjacency row when it has to move. */
+#define MINROWSLOTS 4
 #define UNVISITED 0
 #define VISITED 1
 #define MYINTMAX 99999
+/* How often getDiameterWithin tries a server picked at random. */
+#define SAMPLEPERIOD 64
+/* How far ahead traversals prefetch queued servers and neighbours. */
+#define PREFETCHDISTANCE 4
+/* Number of per-server buffers in a workspace. */
+#define WORKSPACEBUFFERS 23
 
 struct edge;
 
@@ -28,12 +38,26 @@ struct graph {
   int numEdges;
   int allocedEdges;
   struct edge **edgeList;
+  int maxWeight;
+  /* Adjacency rows, built from the edge list the first time they are needed.
+    After that the edge list is freed and changes go straight to the rows. */
+  int adjacencyBuilt;
+  struct adjacency adjacency;
+  /* Room reserved for each row, and how many slots are in use, allocated and
+    left behind by rows which had to move. */
+  int *rowSlots;
+  int usedSlots;
+  int allocedSlots;
+  int deadSlots;
+  /* 1 for servers which have been decommissioned, NULL if there are none. */
+  int *removed;
 };
 
 /* Definition of an edge. */
 struct edge {
   int start;
   int end;
+  int weight;
 };
 
 struct graph *newGraph(int numVertices){
@@ -44,13 +68,101 @@ struct graph *newGraph(int numVertices){
   g->numEdges = 0;
   g->allocedEdges = 0;
   g->edgeList = NULL;
+  g->maxWeight = 0;
+  g->adjacencyBuilt = 0;
+  g->adjacency.numVertices = numVertices;
+  g->adjacency.maxWeight = 0;
+  g->adjacency.start = NULL;
+  g->adjacency.len = NULL;
+  g->adjacency.target = NULL;
+  g->adjacency.weight = NULL;
+  g->rowSlots = NULL;
+  g->usedSlots = 0;
+  g->allocedSlots = 0;
+  g->deadSlots = 0;
+  g->removed = NULL;
   return g;
 }
 
+/* Makes room for at least extra more slots at the end of the rows. */
+static void reserveSlots(struct graph *g, int extra){
+  struct adjacency *adj = &(g->adjacency);
+  if(g->usedSlots + extra <= g->allocedSlots){
+    return;
+  }
+  while(g->usedSlots + extra > g->allocedSlots){
+    g->allocedSlots = g->allocedSlots > 0 ? 2 * g->allocedSlots : INITIALEDGES;
+  }
+  adj->target = (int *) hugeRealloc(adj->target, sizeof(int) * g->allocedSlots);
+  adj->weight = (int *) hugeRealloc(adj->weight, sizeof(int) * g->allocedSlots);
+}
+
+/* Adds w to the row of v. A full row moves to the end with twice the room,
+  leaving its old slots dead until the next compaction. */
+static void addSlot(struct graph *g, int v, int w, int weight){
+  struct adjacency *adj = &(g->adjacency);
+  int k, slots;
+  if((adj->len)[v] == (g->rowSlots)[v]){
+    slots = max(MINROWSLOTS, 2 * (g->rowSlots)[v]);
+    reserveSlots(g, slots);
+    for(k = 0; k < (adj->len)[v]; k++){
+      (adj->target)[g->usedSlots + k] = (adj->target)[(adj->start)[v] + k];
+      (adj->weight)[g->usedSlots + k] = (adj->weight)[(adj->start)[v] + k];
+    }
+    g->deadSlots += (g->rowSlots)[v];
+    (adj->start)[v] = g->usedSlots;
+    (g->rowSlots)[v] = slots;
+    g->usedSlots += slots;
+  }
+  k = (adj->start)[v] + (adj->len)[v]++;
+  (adj->target)[k] = w;
+  (adj->weight)[k] = weight;
+}
+
+/* Takes one w out of the row of v by moving the row's last entry into its
+  place. Returns 1 if w was found. */
+static int removeSlot(struct graph *g, int v, int w){
+  struct adjacency *adj = &(g->adjacency);
+  int k, last = (adj->start)[v] + (adj->len)[v] - 1;
+  for(k = (adj->start)[v]; k <= last; k++){
+    if((adj->target)[k] == w){
+      (adj->target)[k] = (adj->target)[last];
+      (adj->weight)[k] = (adj->weight)[last];
+      (adj->len)[v]--;
+      return 1;
+    }
+  }
+  return 0;
+}
+
 /* Adds an edge to the given graph. */
 void addEdge(struct graph *g, int start, int end){
+  addWeightedEdge(g, start, end, 1);
+}
+
+/* Adds an edge with the given cost to the given graph. */
+void addWeightedEdge(struct graph *g, int start, int end, int weight){
   assert(g);
+  assert(weight >= 0);
+  /* A shortest path has fewer edges than vertices, so with this bound no
+    distance (or distance plus one more edge) reaches NOPATH. */
+  assert((long long) weight * g->numVertices < NOPATH);
+  assert(start >= 0 && end >= 0 && start < g->numVertices &&
+    end < g->numVertices);
   struct edge *newEdge = NULL;
+  if(weight > g->maxWeight){
+    g->maxWeight = weight;
+  }
+  if(g->adjacencyBuilt){
+    /* Live graph, add the edge to the rows of both of its ends. */
+    addSlot(g, start, end, weight);
+    if(end != start){
+      addSlot(g, end, start, weight);
+    }
+    g->adjacency.maxWeight = g->maxWeight;
+    (g->numEdges)++;
+    return;
+  }
   /* Check we have enough space for the new edge. */
   if((g->numEdges + 1) > g->allocedEdges){
     if(g->allocedEdges == 0){
@@ -68,24 +180,322 @@ void addEdge(struct graph *g, int start, int end){
   assert(newEdge);
   newEdge->start = start;
   newEdge->end = end;
+  newEdge->weight = weight;
 
   /* Add the edge to the list of edges. */
   g->edgeList[g->numEdges] = newEdge;
   (g->numEdges)++;
 }
 
-/* Frees all memory used by graph. */
-void freeGraph(struct graph *g){
+static void freeAdjacency(struct adjacency *adj){
+  hugeFree(adj->start);
+  hugeFree(adj->len);
+  hugeFree(adj->target);
+  hugeFree(adj->weight);
+  adj->start = NULL;
+  adj->len = NULL;
+  adj->target = NULL;
+  adj->weight = NULL;
+}
+
+/* Frees the edge list, once its edges are in the adjacency rows. */
+static void freeEdgeList(struct graph *g){
   int i;
+  if(! g->edgeList){
+    return;
+  }
   for(i = 0; i < g->numEdges; i++){
     free((g->edgeList)[i]);
   }
-  if(g->edgeList){
-    free(g->edgeList);
+  free(g->edgeList);
+  g->edgeList = NULL;
+  g->allocedEdges = 0;
+}
+
+struct adjacency *getAdjacency(struct graph *g){
+  struct adjacency *adj = &(g->adjacency);
+  int i, v, w, slot;
+  if(g->adjacencyBuilt){
+    return adj;
+  }
+  adj->maxWeight = g->maxWeight;
+  /* the rows are read in every traversal, so they go in huge pages */
+  adj->start = (int *) hugeAlloc(sizeof(int) * (g->numVertices + 1));
+  adj->len = (int *) hugeCalloc(sizeof(int) * (g->numVertices + 1));
+  g->rowSlots = (int *) hugeAlloc(sizeof(int) * (g->numVertices + 1));
+  /* Each edge appears in the rows of both of its ends (once for a loop). */
+  g->usedSlots = 0;
+  g->allocedSlots = 0;
+  g->deadSlots = 0;
+  reserveSlots(g, 2 * g->numEdges + 1);
+
+  /* Count the row lengths, then place each edge in its rows. */
+  for(i = 0; i < g->numEdges; i++){
+    (adj->len)[g->edgeList[i]->start]++;
+    if(g->edgeList[i]->end != g->edgeList[i]->start){
+      (adj->len)[g->edgeList[i]->end]++;
+    }
   }
+  slot = 0;
+  for(v = 0; v < g->numVertices; v++){
+    (adj->start)[v] = slot;
+    (g->rowSlots)[v] = (adj->len)[v];
+    slot += (adj->len)[v];
+    (adj->len)[v] = 0;
+  }
+  (adj->start)[g->numVertices] = slot;
+  (g->rowSlots)[g->numVertices] = 0;
+  g->usedSlots = slot;
+  for(i = 0; i < g->numEdges; i++){
+    v = g->edgeList[i]->start;
+    w = g->edgeList[i]->end;
+    slot = (adj->start)[v] + (adj->len)[v]++;
+    (adj->target)[slot] = w;
+    (adj->weight)[slot] = g->edgeList[i]->weight;
+    if(w != v){
+      slot = (adj->start)[w] + (adj->len)[w]++;
+      (adj->target)[slot] = v;
+      (adj->weight)[slot] = g->edgeList[i]->weight;
+    }
+  }
+  g->adjacencyBuilt = 1;
+  freeEdgeList(g);
+  return adj;
+}
+
+int deleteEdge(struct graph *g, int start, int end){
+  getAdjacency(g);
+  if(start < 0 || end < 0 || start >= g->numVertices ||
+    end >= g->numVertices || ! removeSlot(g, start, end)){
+    return 0;
+  }
+  if(end != start){
+    assert(removeSlot(g, end, start));
+  }
+  (g->numEdges)--;
+  return 1;
+}
+
+int removeServer(struct graph *g, int v){
+  struct adjacency *adj = getAdjacency(g);
+  int k, w;
+  if(v < 0 || v >= g->numVertices || isRemoved(g, v)){
+    return 0;
+  }
+  for(k = (adj->start)[v]; k < (adj->start)[v] + (adj->len)[v]; k++){
+    w = (adj->target)[k];
+    if(w != v){
+      assert(removeSlot(g, w, v));
+    }
+    (g->numEdges)--;
+  }
+  (adj->len)[v] = 0;
+  if(! g->removed){
+    g->removed = (int *) calloc(g->numVertices, sizeof(int));
+    assert(g->removed);
+  }
+  (g->removed)[v] = 1;
+  return 1;
+}
+
+int isRemoved(struct graph *g, int v){
+  return g->removed && v >= 0 && v < g->numVertices && (g->removed)[v];
+}
+
+void compactGraph(struct graph *g){
+  struct adjacency *adj = getAdjacency(g);
+  int v, k, slot = 0, total = 0;
+  for(v = 0; v < g->numVertices; v++){
+    total += (adj->len)[v];
+  }
+  int *target = (int *) hugeAlloc(sizeof(int) * (total + 1));
+  int *weight = (int *) hugeAlloc(sizeof(int) * (total + 1));
+  /* Lay the rows out again in server order with no room to spare. */
+  for(v = 0; v < g->numVertices; v++){
+    for(k = 0; k < (adj->len)[v]; k++){
+      target[slot + k] = (adj->target)[(adj->start)[v] + k];
+      weight[slot + k] = (adj->weight)[(adj->start)[v] + k];
+    }
+    (adj->start)[v] = slot;
+    (g->rowSlots)[v] = (adj->len)[v];
+    slot += (adj->len)[v];
+  }
+  (adj->start)[g->numVertices] = slot;
+  hugeFree(adj->target);
+  hugeFree(adj->weight);
+  adj->target = target;
+  adj->weight = weight;
+  g->usedSlots = slot;
+  g->allocedSlots = total + 1;
+  g->deadSlots = 0;
+}
+
+int applyChanges(struct graph *g, int numServers, struct edgeChange *changes,
+  int count){
+  int i, applied = 0;
+  getAdjacency(g);
+  for(i = 0; i < count; i++){
+    if(changes[i].kind == ADD_CONNECTION){
+      if(changes[i].start < 0 || changes[i].end < 0 ||
+        changes[i].start >= numServers || changes[i].end >= numServers ||
+        isRemoved(g, changes[i].start) || isRemoved(g, changes[i].end)){
+        continue;
+      }
+      addWeightedEdge(g, changes[i].start, changes[i].end, changes[i].weight);
+      applied++;
+    } else if(changes[i].kind == DELETE_CONNECTION){
+      applied += deleteEdge(g, changes[i].start, changes[i].end);
+    } else if(changes[i].kind == REMOVE_SERVER){
+      applied += removeServer(g, changes[i].start);
+    }
+  }
+  /* Compact once the rows which moved have left more dead slots than there
+    are slots in use. */
+  if(g->deadSlots > g->usedSlots - g->deadSlots){
+    compactGraph(g);
+  }
+  return applied;
+}
+
+/* Frees all memory used by graph. */
+void freeGraph(struct graph *g){
+  freeEdgeList(g);
+  freeAdjacency(&(g->adjacency));
+  hugeFree(g->rowSlots);
+  free(g->removed);
   free(g);
 }
 
+/* Scratch space for traversals, kept between calls so that repeated queries
+  don't need to allocate. */
+struct workspace {
+  int capacity;
+  int *visited;
+  int *dist;
+  int *prev;
+  int *finalprev;
+  int *outageMask;
+  int *queue;
+  int *stack;
+  int *nextedge;
+  int *order;
+  int *hra;
+  int *parent;
+  int *iscritical;
+  int *lower;
+  int *upper;
+  int *candidates;
+  int *pendant;
+  /* Subnetwork labels, filled in by getComponents. */
+  struct components components;
+  struct pq *priq;
+  struct mpq *mpq;
+  int mpqMaxWeight;
+  /* Where the buffers above are taken from. */
+  struct arena *arena;
+};
+
+static void freeWorkspaceBuffers(struct workspace *ws){
+  freeArena(ws->arena);
+  freePQ(ws->priq);
+}
+
+/* Takes a buffer of size ints from the workspace's arena. */
+static int *newBuffer(struct workspace *ws, int size){
+  return (int *) arenaAlloc(ws->arena, sizeof(int) * size);
+}
+
+/* Makes sure the workspace has room for numServers servers. */
+static void reserveWorkspace(struct workspace *ws, int numServers){
+  int size;
+  if(numServers <= ws->capacity){
+    return;
+  }
+  if(ws->capacity > 0){
+    freeWorkspaceBuffers(ws);
+  }
+  size = numServers > 0 ? numServers : 1;
+  ws->capacity = numServers;
+  /* every buffer comes from one arena, so together they take as few pages
+    (and TLB entries) as possible */
+  ws->arena = newArena(WORKSPACEBUFFERS * (sizeof(int) * (size + 1) + 64));
+  ws->visited = newBuffer(ws, size);
+  ws->dist = newBuffer(ws, size);
+  ws->prev = newBuffer(ws, size);
+  ws->finalprev = newBuffer(ws, size);
+  ws->outageMask = newBuffer(ws, size);
+  ws->queue = newBuffer(ws, size);
+  ws->stack = newBuffer(ws, size);
+  ws->nextedge = newBuffer(ws, size);
+  ws->order = newBuffer(ws, size);
+  ws->hra = newBuffer(ws, size);
+  ws->parent = newBuffer(ws, size);
+  ws->iscritical = newBuffer(ws, size);
+  ws->lower = newBuffer(ws, size);
+  ws->upper = newBuffer(ws, size);
+  ws->candidates = newBuffer(ws, size);
+  ws->pendant = newBuffer(ws, size);
+  ws->components.label = newBuffer(ws, size);
+  ws->components.size = newBuffer(ws, size);
+  ws->components.minSID = newBuffer(ws, size);
+  ws->components.memberStart = newBuffer(ws, size + 1);
+  ws->components.members = newBuffer(ws, size);
+  ws->components.bySize = newBuffer(ws, size);
+  ws->components.sizeStart = newBuffer(ws, size + 1);
+  ws->components.numServers = 0;
+  ws->components.numComponents = 0;
+  ws->priq = newIndexedPQ(size);
+}
+
+struct workspace *newWorkspace(int numServers){
+  struct workspace *ws = (struct workspace *) malloc(sizeof(struct workspace));
+  assert(ws);
+  ws->capacity = 0;
+  ws->mpq = NULL;
+  ws->mpqMaxWeight = -1;
+  reserveWorkspace(ws, numServers);
+  return ws;
+}
+
+int *workspaceOutageMask(struct workspace *ws){
+  assert(ws);
+  return ws->outageMask;
+}
+
+void freeWorkspace(struct workspace *ws){
+  if(! ws){
+    return;
+  }
+  if(ws->capacity > 0){
+    freeWorkspaceBuffers(ws);
+  }
+  freeMPQ(ws->mpq);
+  free(ws);
+}
+
+/* Returns the workspace's monotone queue, emptied and suited to the costs of
+  the given graph. */
+static struct mpq *getWorkspaceMPQ(struct workspace *ws, struct graph *g){
+  struct adjacency *adj = getAdjacency(g);
+  if(ws->mpq && ws->mpqMaxWeight == adj->maxWeight){
+    resetMPQ(ws->mpq);
+    return ws->mpq;
+  }
+  freeMPQ(ws->mpq);
+  ws->mpq = newMPQ(adj->maxWeight);
+  ws->mpqMaxWeight = adj->maxWeight;
+  return ws->mpq;
+}
+
+struct solution *graphSolve(struct graph *g, enum problemPart part,
+  int numServers, int numOutages, int *outages){
+  struct workspace *ws = newWorkspace(numServers);
+  struct solution *solution = graphSolveWith(ws, g, part, numServers,
+    numOutages, outages);
+  freeWorkspace(ws);
+  return solution;
+}
+
 /* Finds:
   - Number of connected subnetworks (before outage) (Task 2)
   - Number of servers in largest subnetwork (before outage) (Task 3)
@@ -94,96 +504,66 @@ void freeGraph(struct graph *g){
   - Number of servers in path with largest diameter - should be one more than
     Diameter if a path exists (after outage) (Task 4)
   - SIDs in path with largest diameter (after outage) (Task 4)
+  - Weighted diameter, number of servers and SIDs in the path with the largest
+    weighted diameter (after outage) (Task 4 weighted)
+  - Eccentricity of every server, radius and centre servers of the largest
+    subnetwork (after outage) (Eccentricity)
   - Number of critical servers (before outage) (Task 7)
   - SIDs of critical servers (before outage) (Task 7)
+  All scratch space comes from the workspace, the only allocations are for the
+  solution returned.
 */
-struct solution *graphSolve(struct graph *g, enum problemPart part,
-  int numServers, int numOutages, int *outages){
+struct solution *graphSolveWith(struct workspace *ws, struct graph *g,
+  enum problemPart part, int numServers, int numOutages, int *outages){
   struct solution *solution = (struct solution *)
     malloc(sizeof(struct solution));
   assert(solution);
   /* Initialise solution values */
   initaliseSolution(solution);
-  int visited[numServers];
+  reserveWorkspace(ws, numServers);
+  int *visited = ws->visited;
   if(part == TASK_2){
     /* TASK 2 SOLUTION */
     solution->connectedSubnets = 0;
-    int i;
-
-    for(i = 0; i < numServers; i++) {
-      visited[i] = UNVISITED;
-    }
-
-    for(i = 0; i < numServers; i++) {
-      if (visited[i]) continue;
-      /* do a dfs traversal of the subnetwork */
-      getConnectedSubnets(g, i, visited, numServers);
-
-      /* each time the function getConnectedSubnets is called, it means we have found another subnetwork which has node "i" in it */
-      solution->connectedSubnets += 1;
-    }
+    struct components *components = getComponents(ws, g, numServers, NULL);
+    solution->connectedSubnets = components->numComponents;
 
   } else if(part == TASK_3) {
     /* TASK 3 SOLUTION */
     solution->largestSubnet = 0;
     solution->largestSubnetSIDs = NULL;
 
-    int i, tempnum;
-    int tempserver = -1, *servers;
-
-    for(i = 0; i < numServers; i++) {
-      visited[i] = UNVISITED;
+    int largest, *servers;
+    struct components *components = getComponents(ws, g, numServers, NULL);
+
+    /* the largest subnetwork, ties going to the one with the smaller server */
+    if (topComponents(components, 1, &largest) == 1) {
+      solution->largestSubnet = components->size[largest];
+      servers = (int*)malloc(sizeof(int)*solution->largestSubnet);
+      assert(servers);
+      /* members are already in increasing order */
+      memcpy(servers, components->members + components->memberStart[largest],
+        sizeof(int)*solution->largestSubnet);
+      solution->largestSubnetSIDs = servers;
     }
 
-    for(i = 0; i < numServers; i++) {
-      if (!(visited[i])) {
-        /* tempnum stores the length of the current subnetwork which has node "i" in it. This is the local maximum */
-        tempnum = 1 + getLargestSubnet(g, i, visited, numServers);
-
-        /* compare with the global maximum and update if bigger */
-        if (tempnum > solution->largestSubnet) {
-          solution->largestSubnet = tempnum;
-          tempserver = i;
-        } else if (tempnum == solution->largestSubnet && tempserver > i) {
-          /* if two subnetworks with the same number of nodes found, pick the one with the smaller server */
-          solution->largestSubnet = tempnum;
-          tempserver = i;
-        }
-      }
-    }
-
-    for(i = 0; i < numServers; i++) {
-      visited[i] = UNVISITED;
-    }
-
-    /* populate the array visited to find which servers are in the largest subnetwork found previously */
-    getservers(g, tempserver, visited);
-
-    servers = (int*)malloc(sizeof(int)*solution->largestSubnet);
-    assert(servers);
-    int j = 0;
-    for (i = 0; i < numServers && j < solution->largestSubnet; i++) {
-      if (visited[i]) {
-        servers[j] = i;
-        j++;
-      }
-    }
-    qsort(servers, solution->largestSubnet, sizeof(int), cmpfunc);
-    solution->largestSubnetSIDs = servers;
-
   } else if(part == TASK_4) {
     /* TASK 4 SOLUTION */
     solution->postOutageDiameter = 0;
     solution->postOutageDiameterCount = 0;
     solution->postOutageDiameterSIDs = NULL;
 
-    int dist[numServers], prev[numServers], finalprev[numServers], i;
+    int *dist = ws->dist, *prev = ws->prev, *finalprev = ws->finalprev, i;
+    int *outageMask = ws->outageMask;
     int startserver, endserver, maxpathlength = 0, tempmax = 0, tempend;
 
+    getOutageMask(outageMask, numServers, outages, numOutages);
+    maskRemoved(g, outageMask, numServers);
+
     for (i = 0; i<numServers; i++) {
-      if (isOut(i, outages, numOutages)) continue;
+      if (outageMask[i]) continue;
       /* "i" is a node that hasn't been affected by the outage, get the shortest paths from i to other nodes in the network */
-      dijkstras(g, i, dist, prev, numServers, outages, numOutages);
+      dijkstras(ws, g, i, dist, prev, numServers, outageMask);
 
       /* find the length of longest shortest path from this node and the end server of that path */
       getLocalMax(dist, prev, &tempmax, &tempend, numServers);
@@ -192,15 +572,18 @@ struct solution *graphSolve(struct graph *g, enum problemPart part,
       getMax(&startserver, &endserver, &maxpathlength, tempmax, prev, finalprev, numServers, tempend, i);
     }
     solution->postOutageDiameter = maxpathlength;
-    solution->postOutageDiameterCount = solution->postOutageDiameter + 1;
+    /* no connection survived the outage, so there is no path to report */
+    if (maxpathlength > 0) {
+      solution->postOutageDiameterCount = solution->postOutageDiameter + 1;
 
-    int *servers = (int*)malloc(sizeof(int)*solution->postOutageDiameterCount);
-    assert(servers);
+      int *servers = (int*)malloc(sizeof(int)*solution->postOutageDiameterCount);
+      assert(servers);
 
-    /* get the servers in the previously found longest shortest path */
-    populateServers(servers, finalprev, startserver, endserver, solution->postOutageDiameter);
+      /* get the servers in the previously found longest shortest path */
+      populateServers(servers, finalprev, startserver, endserver, solution->postOutageDiameter);
 
-    solution->postOutageDiameterSIDs = servers;
+      solution->postOutageDiameterSIDs = servers;
+    }
 
   } else if(part == TASK_7) {
     /* TASK 7 SOLUTION */
@@ -214,7 +597,7 @@ struct solution *graphSolve(struct graph *g, enum problemPart part,
      - hra[]: stores the highest reachable ancestor(hra) of nodes
      - iscritical[]: 1 if a node is a critical vertex else 0
     */
-    int visited[numServers], order[numServers], parent[numServers], hra[numServers], iscritical[numServers];
+    int *order = ws->order, *parent = ws->parent, *hra = ws->hra, *iscritical = ws->iscritical;
     int i, j = 0, count = 0, *critical, criticalServerCount = 0;
 
     for(i = 0; i < numServers; i++) {
@@ -226,7 +609,7 @@ struct solution *graphSolve(struct graph *g, enum problemPart part,
     for(i = 0; i < numServers; i++) {
       if (!(visited[i])) {
         /* the follwing function does dfs traversal, finds the push orders and hra. then for every node, it checks whether it is a critical node and populates the iscrtical[] array */
-        getOrderAndHRA(g, iscritical, i, visited, order, hra, parent, numServers, &count, &criticalServerCount);
+        getOrderAndHRA(ws, g, iscritical, i, visited, order, hra, parent, numServers, &count, &criticalServerCount);
       }
     }
     
@@ -241,55 +624,195 @@ struct solution *graphSolve(struct graph *g, enum problemPart part,
     }
     solution->criticalServerCount = criticalServerCount;
     solution->criticalServerSIDs = critical; 
+  } else if(part == TASK_4_WEIGHTED) {
+    /* TASK 4 SOLUTION OVER EDGE COSTS */
+    solution->postOutageDiameter = 0;
+    solution->postOutageDiameterCount = 0;
+    solution->postOutageDiameterSIDs = NULL;
+
+    int *dist = ws->dist, *prev = ws->prev, *finalprev = ws->finalprev;
+    int *outageMask = ws->outageMask;
+    int i, j, startserver = -1, endserver = -1, maxpathlength = -1;
+
+    getOutageMask(outageMask, numServers, outages, numOutages);
+    maskRemoved(g, outageMask, numServers);
+
+    for (i = 0; i < numServers; i++) {
+      if (outageMask[i]) continue;
+      weightedDijkstras(ws, g, i, dist, prev, numServers, outageMask);
+
+      /* sources are tried in increasing order and ends in increasing order, so
+        only a strictly longer path replaces the current one */
+      for (j = 0; j < numServers; j++) {
+        if (prev[j] != -1 && dist[j] > maxpathlength) {
+          maxpathlength = dist[j];
+          startserver = i;
+          endserver = j;
+          memcpy(finalprev, prev, sizeof(int) * numServers);
+        }
+      }
+    }
+
+    if (startserver != -1) {
+      /* count the servers on the path, then fill them in from the end */
+      int count = 1;
+      for (j = endserver; j != startserver; j = finalprev[j]) {
+        count++;
+      }
+      int *servers = (int*)malloc(sizeof(int)*count);
+      assert(servers);
+      i = count - 1;
+      for (j = endserver; j != startserver; j = finalprev[j]) {
+        servers[i--] = j;
+      }
+      servers[0] = startserver;
+
+      solution->postOutageDiameter = maxpathlength;
+      solution->postOutageDiameterCount = count;
+      solution->postOutageDiameterSIDs = servers;
+    }
+  } else if(part == TASK_ECCENTRICITY) {
+    /* ECCENTRICITY SOLUTION */
+    int *outageMask = ws->outageMask;
+
+    getOutageMask(outageMask, numServers, outages, numOutages);
+    maskRemoved(g, outageMask, numServers);
+
+    int *ecc = (int*)malloc(sizeof(int)*numServers);
+    assert(ecc);
+    solution->eccentricityTraversals = getEccentricities(ws, g, ecc, numServers, outageMask);
+    solution->eccentricityCount = numServers;
+    solution->eccentricities = ecc;
+
+    getCentre(ws, g, numServers, outageMask, solution);
   }
   return solution;
 }
 
-void getConnectedSubnets(struct graph *g, int v, int visited[], int nvisited) {
-  /* dfs of the network containing node "v" */
-  visited[v] = VISITED;
-
-  int i, w;
-  /* visit all the adjacent nodes */
-  for (i = 0; i < g->numEdges; i++) {
-      w = isAdjacent(g, i, v);
-      if (w == -1) continue;
-      
-      if (!(visited[w])) {
-        getConnectedSubnets(g, w, visited, nvisited);
+void getCentre(struct workspace *ws, struct graph *g, int numServers,
+  int outageMask[], struct solution *solution) {
+  int i, largest, size, *members, *ecc = solution->eccentricities;
+
+  /* the radius is the smallest eccentricity in the largest subnetwork (ties
+    going to the one with the smaller server) and the centre is every server
+    in it which has that eccentricity */
+  struct components *components = getComponents(ws, g, numServers, outageMask);
+  if (topComponents(components, 1, &largest) == 1) {
+    members = components->members + components->memberStart[largest];
+    size = components->size[largest];
+    solution->postOutageRadius = NOPATH;
+    for (i = 0; i < size; i++) {
+      solution->postOutageRadius = min(solution->postOutageRadius, ecc[members[i]]);
+    }
+    int *centre = (int*)malloc(sizeof(int)*size);
+    assert(centre);
+    solution->centreCount = 0;
+    for (i = 0; i < size; i++) {
+      if (ecc[members[i]] == solution->postOutageRadius) {
+        centre[solution->centreCount] = members[i];
+        solution->centreCount++;
       }
     }
+    solution->centreSIDs = centre;
+  }
 }
 
-int getLargestSubnet(struct graph *g, int v, int visited[], int n){
-  visited[v] = VISITED;
-  int i, w, count = 0;
+struct components *getComponents(struct workspace *ws, struct graph *g,
+  int numServers, int outageMask[]) {
+  struct adjacency *adj = getAdjacency(g);
+  struct components *c = &(ws->components);
+  int *stack = ws->stack, *fill = ws->nextedge;
+  int i, k, u, w, top, label;
+
+  c->numServers = numServers;
+  c->numComponents = 0;
+  for (i = 0; i < numServers; i++) {
+    c->label[i] = -1;
+  }
 
-  for (i = 0; i < g->numEdges; i++) {
-      w = isAdjacent(g, i, v);
-      if (w == -1) continue;
-      
-      if (!(visited[w])) {
-        /* "count" keeps a track of the #nodes in the current network */
-        count = count + 1 + getLargestSubnet(g, w, visited, n);
+  /* servers are tried in increasing order, so each subnetwork's label is
+    given by its smallest server and labels are in order of smallest server */
+  for (i = 0; i < numServers; i++) {
+    if (c->label[i] != -1 || (outageMask && outageMask[i])) continue;
+    /* decommissioned servers have no connections and belong to no subnetwork */
+    if (isRemoved(g, i)) continue;
+    label = c->numComponents++;
+    c->minSID[label] = i;
+    c->size[label] = 1;
+    c->label[i] = label;
+    top = 0;
+    stack[top++] = i;
+    while (top > 0) {
+      u = stack[--top];
+      for (k = adj->start[u]; k < adj->start[u] + adj->len[u]; k++) {
+        w = adj->target[k];
+        if (k + PREFETCHDISTANCE < adj->start[u] + adj->len[u]) {
+          PREFETCH(&c->label[adj->target[k + PREFETCHDISTANCE]]);
+        }
+        if (w >= numServers || c->label[w] != -1) continue;
+        if (outageMask && outageMask[w]) continue;
+        c->label[w] = label;
+        c->size[label]++;
+        stack[top++] = w;
       }
     }
-  return count;
+  }
+
+  /* counting sort of the servers by label, taking servers in increasing
+    order so that every member list comes out sorted */
+  c->memberStart[0] = 0;
+  for (label = 0; label < c->numComponents; label++) {
+    c->memberStart[label + 1] = c->memberStart[label] + c->size[label];
+    fill[label] = c->memberStart[label];
+  }
+  for (i = 0; i < numServers; i++) {
+    if (c->label[i] != -1) {
+      c->members[fill[c->label[i]]++] = i;
+    }
+  }
+  return c;
 }
 
-void getservers(struct graph *g, int tempserver, int visited[]) {
-  /* vitied[i] will be 1 if the node is visited else 0. this finds which nodes are in the current network */
-  visited[tempserver] = VISITED;
-  int i, w;
+int topComponents(struct components *c, int k, int top[]) {
+  /* counting sort of the labels by size, largest first, with labels of the
+    same size kept in increasing order */
+  int *bysize = c->bySize, *start = c->sizeStart;
+  int label, size, count;
 
-  for (i = 0; i < g->numEdges; i++) {
-      w = isAdjacent(g, i, tempserver);
-      if (w == -1) continue;
-      
-      if (!(visited[w])) {
-        getservers(g, w, visited);
-      }
-    }
+  for (size = 0; size <= c->numServers; size++) {
+    start[size] = 0;
+  }
+  for (label = 0; label < c->numComponents; label++) {
+    start[c->size[label]]++;
+  }
+  /* start[size] becomes the first position for that size, biggest first */
+  count = 0;
+  for (size = c->numServers; size >= 0; size--) {
+    int here = start[size];
+    start[size] = count;
+    count += here;
+  }
+  for (label = 0; label < c->numComponents; label++) {
+    bysize[start[c->size[label]]++] = label;
+  }
+
+  if (k > c->numComponents) k = c->numComponents;
+  for (count = 0; count < k; count++) {
+    top[count] = bysize[count];
+  }
+  return k;
+}
+
+int getSizeHistogram(struct components *c, int histogram[]) {
+  int label, size, largest = 0;
+  for (size = 0; size <= c->numServers; size++) {
+    histogram[size] = 0;
+  }
+  for (label = 0; label < c->numComponents; label++) {
+    histogram[c->size[label]]++;
+    largest = max(largest, c->size[label]);
+  }
+  return largest;
 }
 
 int cmpfunc (const void * a, const void * b) {
@@ -308,7 +831,7 @@ int isOut(int vertex, int outageSIDs[], int numoutages) {
   return 0;
 }
 
-void dijkstras(struct graph *g, int start, int dist[], int prev[], int n, int outageSIDs[], int numoutages) {
+void dijkstras(struct workspace *ws, struct graph *g, int start, int dist[], int prev[], int n, int outageMask[]) {
   int i, u;
 
   for (i = 0; i < n; i++) {
@@ -318,7 +841,8 @@ void dijkstras(struct graph *g, int start, int dist[], int prev[], int n, int ou
 
   dist[start] = 0;
 
-  struct pq *priq = newPQ();
+  struct pq *priq = ws->priq;
+  clearPQ(priq);
   for (i = 0; i < n; i++) {
     /* initialise priority queue with distance from source node as priority */
     enqueue(priq, i, dist[i]);
@@ -326,23 +850,338 @@ void dijkstras(struct graph *g, int start, int dist[], int prev[], int n, int ou
   
   while(!empty(priq)) {
     u = deletemin(priq);
-    updatecosts(g, priq, u, dist, prev, outageSIDs, numoutages);
+    updatecosts(g, priq, u, dist, prev, outageMask);
+  }
+}
+
+void maskRemoved(struct graph *g, int mask[], int n) {
+  int i;
+  if (!g->removed) return;
+  for (i = 0; i < n && i < g->numVertices; i++) {
+    if (g->removed[i]) mask[i] = 1;
+  }
+}
+
+void getOutageMask(int mask[], int n, int outageSIDs[], int numoutages) {
+  int i;
+  for (i = 0; i < n; i++) {
+    mask[i] = 0;
+  }
+  for (i = 0; i < numoutages; i++) {
+    if (outageSIDs[i] >= 0 && outageSIDs[i] < n) {
+      mask[outageSIDs[i]] = 1;
+    }
+  }
+}
+
+void weightedDijkstras(struct workspace *ws, struct graph *g, int start, int dist[], int prev[], int n, int outageMask[]) {
+  struct adjacency *adj = getAdjacency(g);
+  int i, k, u, w, d;
+
+  for (i = 0; i < n; i++) {
+    dist[i] = NOPATH;
+    prev[i] = -1;
+  }
+  dist[start] = 0;
+
+  /* the queue may hold several entries for a server, only the one matching
+    its current distance is used */
+  struct mpq *priq = getWorkspaceMPQ(ws, g);
+  mpqEnqueue(priq, start, 0);
+
+  while (!mpqEmpty(priq)) {
+    u = mpqDeletemin(priq, &d);
+    if (d != dist[u]) continue;
+
+    for (k = adj->start[u]; k < adj->start[u] + adj->len[u]; k++) {
+      w = adj->target[k];
+      if (k + PREFETCHDISTANCE < adj->start[u] + adj->len[u]) {
+        PREFETCH(&dist[adj->target[k + PREFETCHDISTANCE]]);
+      }
+      /* do not take into account the servers affected by outage */
+      if (w >= n || outageMask[w]) continue;
+
+      if (dist[u] + adj->weight[k] < dist[w]) {
+        dist[w] = dist[u] + adj->weight[k];
+        prev[w] = u;
+        mpqEnqueue(priq, w, dist[w]);
+      }
+    }
+  }
+}
+
+/* starts fetching the row of the server PREFETCHDISTANCE places further along
+  the queue, and the row start of the one twice as far */
+static void prefetchAhead(struct adjacency *adj, int queue[], int head, int tail) {
+  if (head + 2 * PREFETCHDISTANCE < tail) {
+    PREFETCH(&adj->start[queue[head + 2 * PREFETCHDISTANCE]]);
+  }
+  if (head + PREFETCHDISTANCE < tail) {
+    PREFETCH(&adj->target[adj->start[queue[head + PREFETCHDISTANCE]]]);
+  }
+}
+
+int bfsDistances(struct graph *g, int start, int dist[], int n, int outageMask[], int queue[], int *reached) {
+  struct adjacency *adj = getAdjacency(g);
+  int head = 0, tail = 0, k, u, w;
+
+  /* dist[] only changes for the servers reached, which are left in queue[] */
+  dist[start] = 0;
+  queue[tail++] = start;
+  while (head < tail) {
+    u = queue[head++];
+    prefetchAhead(adj, queue, head, tail);
+    for (k = adj->start[u]; k < adj->start[u] + adj->len[u]; k++) {
+      w = adj->target[k];
+      if (k + PREFETCHDISTANCE < adj->start[u] + adj->len[u]) {
+        PREFETCH(&dist[adj->target[k + PREFETCHDISTANCE]]);
+      }
+      if (w >= n || outageMask[w] || dist[w] != NOPATH) continue;
+      dist[w] = dist[u] + 1;
+      queue[tail++] = w;
+    }
+  }
+  if (reached) {
+    *reached = tail;
+  }
+  /* the last server taken from the queue is one of the furthest */
+  return dist[queue[tail - 1]];
+}
+
+/* returns the only surviving neighbour of "v" if it has exactly one, else -1 */
+static int pendantNeighbour(struct adjacency *adj, int v, int n, int outageMask[]) {
+  int k, w, only = -1;
+  for (k = adj->start[v]; k < adj->start[v] + adj->len[v]; k++) {
+    w = adj->target[k];
+    if (w == v || w >= n || outageMask[w]) continue;
+    if (only != -1 && only != w) return -1;
+    only = w;
   }
+  return only;
 }
 
-void updatecosts(struct graph *g, struct pq *priq, int u, int dist[], int prev[], int outageSIDs[], int numoutages) {
-  int i, w;
+int getEccentricities(struct workspace *ws, struct graph *g, int ecc[], int n, int outageMask[]) {
+  struct adjacency *adj = getAdjacency(g);
+  int *lower = ws->lower, *upper = ws->upper, *dist = ws->dist;
+  int *queue = ws->queue, *candidates = ws->candidates, *pendant = ws->pendant;
+  int i, j, v, e, d, u, reached, numcandidates = 0, traversals = 0;
+  int pickupper = 1;
 
-  for (i = 0; i < g->numEdges; i++) {
-      w = isAdjacent(g, i, u);
-      if (w == -1) continue;
+  for (i = 0; i < n; i++) {
+    ecc[i] = -1;
+    lower[i] = 0;
+    upper[i] = NOPATH;
+    dist[i] = NOPATH;
+    pendant[i] = -1;
+  }
+  for (i = 0; i < n; i++) {
+    if (outageMask[i]) continue;
+    /* a server hanging off a single neighbour which has other neighbours is
+      one hop further from everything than that neighbour, so it is settled as
+      soon as that neighbour is */
+    u = pendantNeighbour(adj, i, n, outageMask);
+    if (u != -1 && pendantNeighbour(adj, u, n, outageMask) == -1) {
+      pendant[i] = u;
+    }
+    candidates[numcandidates++] = i;
+  }
+
+  while (numcandidates > 0) {
+    /* drop settled servers, then alternate between the unsettled server with
+      the largest upper bound (likely on the edge of the network) and the one
+      with the smallest lower bound (likely in the middle), preferring well
+      connected servers */
+    v = -1;
+    for (j = 0; j < numcandidates; j++) {
+      i = candidates[j];
+      if (ecc[i] == -1 && pendant[i] != -1 && ecc[pendant[i]] != -1) {
+        ecc[i] = ecc[pendant[i]] + 1;
+      }
+      if (ecc[i] != -1) {
+        candidates[j--] = candidates[--numcandidates];
+        continue;
+      }
+      if (v == -1) {
+        v = i;
+      } else if (pickupper && (upper[i] > upper[v] ||
+          (upper[i] == upper[v] && adj->len[i] > adj->len[v]))) {
+        v = i;
+      } else if (!pickupper && (lower[i] < lower[v] ||
+          (lower[i] == lower[v] && adj->len[i] > adj->len[v]))) {
+        v = i;
+      }
+    }
+    if (v == -1) break;
+    pickupper = !pickupper;
+
+    e = bfsDistances(g, v, dist, n, outageMask, queue, &reached);
+    traversals++;
+    ecc[v] = e;
+
+    /* any server w at distance d from v has max(d, e - d) <= ecc(w) <= e + d */
+    for (j = 0; j < reached; j++) {
+      i = queue[j];
+      d = dist[i];
+      dist[i] = NOPATH;
+      if (ecc[i] != -1) continue;
+      lower[i] = max(lower[i], max(d, e - d));
+      upper[i] = min(upper[i], e + d);
+      if (lower[i] == upper[i]) {
+        ecc[i] = lower[i];
+      }
+    }
+  }
+  return traversals;
+}
+
+/* breadth first search from "start" recording the server each one was reached
+  from in prev[], returns the smallest server furthest from "start" */
+static int bfsFurthest(struct graph *g, int start, int dist[], int prev[], int n, int outageMask[], int queue[]) {
+  struct adjacency *adj = getAdjacency(g);
+  int head = 0, tail = 0, k, u, w, furthest = start;
+
+  dist[start] = 0;
+  prev[start] = -1;
+  queue[tail++] = start;
+  while (head < tail) {
+    u = queue[head++];
+    if (dist[u] > dist[furthest] || (dist[u] == dist[furthest] && u < furthest)) {
+      furthest = u;
+    }
+    prefetchAhead(adj, queue, head, tail);
+    for (k = adj->start[u]; k < adj->start[u] + adj->len[u]; k++) {
+      w = adj->target[k];
+      if (k + PREFETCHDISTANCE < adj->start[u] + adj->len[u]) {
+        PREFETCH(&dist[adj->target[k + PREFETCHDISTANCE]]);
+      }
+      if (w >= n || outageMask[w] || dist[w] != NOPATH) continue;
+      dist[w] = dist[u] + 1;
+      prev[w] = u;
+      queue[tail++] = w;
+    }
+  }
+  for (k = 0; k < tail; k++) {
+    dist[queue[k]] = NOPATH;
+  }
+  return furthest;
+}
+
+void getDiameterWithin(struct workspace *ws, struct graph *g, int numServers,
+  int outageMask[], int milliseconds, struct solution *solution) {
+  struct adjacency *adj = getAdjacency(g);
+  int *lower = ws->lower, *upper = ws->upper, *dist = ws->dist, *prev = ws->prev;
+  int *queue = ws->queue, *candidates = ws->candidates;
+  int i, j, v, e, d, reached, numcandidates = 0, traversals = 0;
+  int found = 0, beststart = -1, bound, end, pickupper = 0;
+  unsigned int seed = 2463534242u;
+  double deadline = nowMilliseconds() + milliseconds;
+
+  /* no server is further than the size of its subnetwork from any other */
+  struct components *components = getComponents(ws, g, numServers, outageMask);
+  for (i = 0; i < numServers; i++) {
+    dist[i] = NOPATH;
+    if (outageMask[i] || isRemoved(g, i)) continue;
+    lower[i] = 0;
+    upper[i] = components->size[components->label[i]] - 1;
+    candidates[numcandidates++] = i;
+  }
+
+  while (1) {
+    /* drop servers which can't be further from anything than the longest
+      path found, the rest bound the diameter from above */
+    bound = found;
+    for (j = 0; j < numcandidates; j++) {
+      if (upper[candidates[j]] <= found) {
+        candidates[j--] = candidates[--numcandidates];
+      } else {
+        bound = max(bound, upper[candidates[j]]);
+      }
+    }
+    if (numcandidates == 0 || (traversals > 0 && nowMilliseconds() >= deadline)) break;
+
+    /* alternate between the server with the largest upper bound and the one
+      with the smallest lower bound, preferring well connected servers. the
+      largest upper bound is at the far end of the last traversal, so these
+      are double sweeps, each followed by a traversal from the middle which
+      tightens the upper bounds. every SAMPLEPERIOD traversals a server picked
+      at random is tried instead */
+    v = -1;
+    if (traversals % SAMPLEPERIOD == SAMPLEPERIOD - 1) {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      v = candidates[seed % numcandidates];
+    } else {
+      pickupper = !pickupper;
+      for (j = 0; j < numcandidates; j++) {
+        i = candidates[j];
+        if (v == -1) {
+          v = i;
+        } else if (pickupper && (upper[i] > upper[v] ||
+            (upper[i] == upper[v] && adj->len[i] > adj->len[v]))) {
+          v = i;
+        } else if (!pickupper && (lower[i] < lower[v] ||
+            (lower[i] == lower[v] && adj->len[i] > adj->len[v]))) {
+          v = i;
+        }
+      }
+    }
+
+    e = bfsDistances(g, v, dist, numServers, outageMask, queue, &reached);
+    traversals++;
+    if (e > found) {
+      found = e;
+      beststart = v;
+    }
+    upper[v] = e;
+
+    /* any server w at distance d from v has max(d, e - d) <= ecc(w) <= e + d */
+    for (j = 0; j < reached; j++) {
+      i = queue[j];
+      d = dist[i];
+      dist[i] = NOPATH;
+      lower[i] = max(lower[i], max(d, e - d));
+      upper[i] = min(upper[i], e + d);
+    }
+  }
+
+  solution->postOutageDiameter = found;
+  solution->postOutageDiameterBound = bound;
+  solution->postOutageDiameterExact = (bound == found);
+  solution->diameterTraversals = traversals;
+  if (found > 0) {
+    /* walk back along the path to the smallest server furthest from the start */
+    end = bfsFurthest(g, beststart, dist, prev, numServers, outageMask, queue);
+    solution->postOutageDiameterCount = found + 1;
+    int *servers = (int*)malloc(sizeof(int)*solution->postOutageDiameterCount);
+    assert(servers);
+    for (i = found; i >= 0; i--) {
+      servers[i] = end;
+      end = prev[end];
+    }
+    solution->postOutageDiameterSIDs = servers;
+  }
+}
+
+void updatecosts(struct graph *g, struct pq *priq, int u, int dist[], int prev[], int outageMask[]) {
+  struct adjacency *adj = getAdjacency(g);
+  int k, w;
+
+  for (k = adj->start[u]; k < adj->start[u] + adj->len[u]; k++) {
+      w = adj->target[k];
+      if (k + PREFETCHDISTANCE < adj->start[u] + adj->len[u]) {
+        PREFETCH(&dist[adj->target[k + PREFETCHDISTANCE]]);
+      }
 
       /* do not take into account the servers affected by outage */
-      if (isOut(w, outageSIDs, numoutages)) continue;
+      if (!pqhasnode(priq, w) || outageMask[w]) continue;
       
-      if (pqhasnode(priq, w) && dist[u] + 1 < dist[w]) {
+      if (dist[u] + 1 < dist[w]) {
         dist[w] = dist[u] + 1;
         prev[w] = u;
+        /* w leaves the queue soon, fetch where its row is while it waits */
+        PREFETCH(&adj->start[w]);
+        PREFETCH(&adj->len[w]);
         /* update cost for w; shorter path found */
         updatecost(priq, w, dist[w]);
       }
@@ -409,48 +1248,70 @@ void populateServers(int servers[], int finalprev[], int startserver, int endser
   }
 }
 
-void getOrderAndHRA(struct graph *g, int iscritical[], int u, int visited[], int order[], int hra[], int parent[], int numservers, int *count, int *crticalcount) 
+void getOrderAndHRA(struct workspace *ws, struct graph *g, int iscritical[], int root, int visited[], int order[], int hra[], int parent[], int numservers, int *count, int *crticalcount) 
 {
-  int i, v, children = 0;
-  *count += 1;
-  
-  /* mark the given node as visited, store count as its push order and hra */
-  visited[u] = VISITED;
-
-  order[u] = *count;
-  hra[u] = *count;
+  struct adjacency *adj = getAdjacency(g);
+  /* stack[] holds the path from the root to the node being explored and
+    nextedge[u] is the next adjacency entry of u to look at */
+  int *stack = ws->stack, *nextedge = ws->nextedge;
+  int top = 0, u, v, p, children = 0;
 
-  for (i = 0; i < g->numEdges; i++) {
-      v = isAdjacent(g, i, u);
-      if (v == -1) continue;
+  /* mark the given node as visited, store count as its push order and hra */
+  *count += 1;
+  visited[root] = VISITED;
+  order[root] = *count;
+  hra[root] = *count;
+  nextedge[root] = adj->start[root];
+  stack[top++] = root;
+
+  while (top > 0) {
+    u = stack[top - 1];
+    if (nextedge[u] < adj->start[u] + adj->len[u]) {
+      v = adj->target[nextedge[u]++];
+      /* fetch the next neighbour's entries while this one is handled */
+      if (nextedge[u] < adj->start[u] + adj->len[u]) {
+        PREFETCH(&visited[adj->target[nextedge[u]]]);
+        PREFETCH(&order[adj->target[nextedge[u]]]);
+      }
+      if (v >= numservers) continue;
 
       /* u is the parent, v is the child because u is visited before and v is an adjacent node to u */
       if (!(visited[v])) {
-        children += 1;
+        if (u == root) children += 1;
         parent[v] = u;
-        getOrderAndHRA(g, iscritical, v, visited, order, hra, parent, numservers, count, crticalcount);
-
-        hra[u] = min(hra[u], hra[v]);
-
-        /* root condition check */
-        if (parent[u] == -1 && children > 1) {
-          if (!iscritical[u]) {
-            iscritical[u] = 1;
-            *crticalcount += 1;
-          }
-        }
-        /* condition for non-root non-leaf nodes */
-        if (parent[u] != -1 && hra[v] >= order[u]) {
-          if (!iscritical[u]) {
-            iscritical[u] = 1;
-            *crticalcount += 1;
-          }
-        }
+        *count += 1;
+        visited[v] = VISITED;
+        order[v] = *count;
+        hra[v] = *count;
+        nextedge[v] = adj->start[v];
+        stack[top++] = v;
       } else if (v != parent[u]) {
         /* back edge found */
         hra[u] = min(hra[u], order[v]);
       }
+      continue;
     }
+
+    /* all of u's children are done, pass its hra up to its parent */
+    top--;
+    if (top == 0) break;
+    p = parent[u];
+    hra[p] = min(hra[p], hra[u]);
+
+    /* condition for non-root non-leaf nodes */
+    if (parent[p] != -1 && hra[u] >= order[p]) {
+      if (!iscritical[p]) {
+        iscritical[p] = 1;
+        *crticalcount += 1;
+      }
+    }
+  }
+
+  /* root condition check */
+  if (children > 1 && !iscritical[root]) {
+    iscritical[root] = 1;
+    *crticalcount += 1;
+  }
 }
 
 int min(int a, int b) {
@@ -458,13 +1319,7 @@ int min(int a, int b) {
   else return b;
 }
 
-int isAdjacent(struct graph *g, int i, int v) {
-  /* finds the adjacent node of server "v" */
-  int w = -1;
-  if (g->edgeList[i]->start == v) {
-    w = g->edgeList[i]->end;
-  } else if (g->edgeList[i]->end == v) {
-    w = g->edgeList[i]->start;
-  }
-  return w;
-}
\ No newline at end of file
+int max(int a, int b) {
+  if (a > b) return a;
+  else return b;
+}
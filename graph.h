@@ -6,11 +6,18 @@ Visible structs and functions for graph construction and manipulation.
 Skeleton written by Grady Fitzpatrick for COMP20007 Assignment 1 2021 and
   modified for Assignment 2 2021
 */
+#include <limits.h>
 #include "pq.h"
 
+/* Distance given to servers which can't be reached. */
+#define NOPATH INT_MAX
+
 /* Definition of a graph. */
 struct graph;
 
+/* Reusable scratch space for traversals. */
+struct workspace;
+
 enum problemPart;
 
 struct solution;
@@ -27,6 +34,75 @@ struct solution {
   int *postOutageDiameterSIDs;
   int criticalServerCount;
   int *criticalServerSIDs;
+  int eccentricityCount;
+  int *eccentricities;
+  int eccentricityTraversals;
+  int postOutageRadius;
+  int centreCount;
+  int *centreSIDs;
+  /* Certified upper bound on postOutageDiameter, which is exact if they are
+    equal, and the traversals used to find them. */
+  int postOutageDiameterBound;
+  int postOutageDiameterExact;
+  int diameterTraversals;
+};
+#endif
+
+/* Adjacency rows of a graph, built from its edge list on demand. The
+  neighbours of vertex v are target[start[v]] to target[start[v] + len[v] - 1]
+  and weight[] holds the matching edge costs. */
+#ifndef ADJACENCY_STRUCT
+#define ADJACENCY_STRUCT
+struct adjacency {
+  int numVertices;
+  int maxWeight;
+  int *start;
+  int *len;
+  int *target;
+  int *weight;
+};
+#endif
+
+/* Subnetwork of every server, labelled in a single traversal. Labels are in
+  order of each subnetwork's smallest server, and the members of subnetwork c
+  are members[memberStart[c]] to members[memberStart[c + 1] - 1] in increasing
+  order. */
+#ifndef COMPONENTS_STRUCT
+#define COMPONENTS_STRUCT
+struct components {
+  int numServers;
+  int numComponents;
+  /* Per server, -1 for servers affected by the outage. */
+  int *label;
+  /* Per subnetwork. */
+  int *size;
+  int *minSID;
+  int *memberStart;
+  int *members;
+  /* Scratch space for sorting subnetworks by size. */
+  int *bySize;
+  int *sizeStart;
+};
+#endif
+
+/* A change to a live graph. */
+#ifndef CHANGE_ENUM
+#define CHANGE_ENUM
+enum changeKind {
+  ADD_CONNECTION=0,
+  DELETE_CONNECTION=1,
+  REMOVE_SERVER=2
+};
+#endif
+
+/* One change in a change log. For REMOVE_SERVER only start is used. */
+#ifndef EDGE_CHANGE_STRUCT
+#define EDGE_CHANGE_STRUCT
+struct edgeChange {
+  enum changeKind kind;
+  int start;
+  int end;
+  int weight;
 };
 #endif
 
@@ -37,7 +113,9 @@ enum problemPart {
   TASK_2=0,
   TASK_3=1,
   TASK_4=2,
-  TASK_7=3
+  TASK_7=3,
+  TASK_4_WEIGHTED=4,
+  TASK_ECCENTRICITY=5
 };
 #endif
 
@@ -48,6 +126,39 @@ struct graph *newGraph(int numVertices);
 /* Adds an edge to the given graph. */
 void addEdge(struct graph *g, int start, int end);
 
+/* Adds an edge with the given (non-negative) cost to the given graph. Edges
+  added with addEdge have a cost of 1. The cost times the number of vertices
+  must stay below NOPATH so no path length can overflow. */
+void addWeightedEdge(struct graph *g, int start, int end, int weight);
+
+/* Removes one connection between start and end from the given graph. Returns 1
+  if there was one to remove, 0 otherwise. */
+int deleteEdge(struct graph *g, int start, int end);
+
+/* Decommissions server v, removing all of its connections. Decommissioned
+  servers are treated as affected by every outage and belong to no
+  subnetwork. Returns 0 if v was not a server in service, otherwise 1. */
+int removeServer(struct graph *g, int v);
+
+/* Returns 1 if server v has been decommissioned, 0 otherwise. */
+int isRemoved(struct graph *g, int v);
+
+/* Applies a batch of changes in order, compacting the adjacency rows
+  afterwards if moved rows have left too much unused space behind. Returns the
+  number of changes which took effect; connections to decommissioned servers,
+  or to anything but servers 0 to numServers - 1, are not added. */
+int applyChanges(struct graph *g, int numServers, struct edgeChange *changes,
+  int count);
+
+/* Packs the adjacency rows together again, freeing the space left behind by
+  rows which had to move to grow. */
+void compactGraph(struct graph *g);
+
+/* Returns the adjacency rows of the graph, building them from the edges added
+  so far the first time. From then on the rows are updated in place as the
+  graph changes. The rows are owned by the graph. */
+struct adjacency *getAdjacency(struct graph *g);
+
 /* Finds:
   - Number of connected subnetworks (before outage) (Task 2)
   - Number of servers in largest subnetwork (before outage) (Task 3)
@@ -56,12 +167,32 @@ void addEdge(struct graph *g, int start, int end);
   - Number of servers in path with largest diameter - should be one more than
     Diameter if a path exists (after outage) (Task 4)
   - SIDs in largest subnetwork (after outage) (Task 4)
+  - Weighted diameter, number of servers and SIDs in the path with the largest
+    weighted diameter (after outage) (Task 4 weighted)
+  - Eccentricity of every server, radius and centre servers of the largest
+    subnetwork (after outage) (Eccentricity)
   - Number of critical servers (before outage) (Task 7)
   - SIDs of critical servers (before outage) (Task 7)
  */
 struct solution *graphSolve(struct graph *g, enum problemPart part,
   int numServers, int numOutages, int *outages);
 
+/* As for graphSolve, but takes all scratch space from the given workspace so
+  that repeated queries allocate nothing beyond the solution returned. The
+  workspace grows if numServers is larger than it was made for. */
+struct solution *graphSolveWith(struct workspace *ws, struct graph *g,
+  enum problemPart part, int numServers, int numOutages, int *outages);
+
+/* Creates a workspace with room for traversals of numServers servers. */
+struct workspace *newWorkspace(int numServers);
+
+/* Returns the workspace's outage mask buffer, with room for the servers it was
+  created for. It is overwritten by graphSolveWith. */
+int *workspaceOutageMask(struct workspace *ws);
+
+/* Frees all memory used by workspace. */
+void freeWorkspace(struct workspace *ws);
+
 /* Frees all memory used by graph. */
 void freeGraph(struct graph *g);
 
@@ -72,14 +203,20 @@ void initaliseSolution(struct solution *solution);
 /* Frees all data used by solution. */
 void freeSolution(struct solution *solution);
 
-/* finds the number of connected subnetworks by doing DFS traversal of graph */
-void getConnectedSubnets(struct graph *g, int v, int visited[], int nvisited);
+/* labels the subnetwork of every server in one traversal, skipping servers
+  with outageMask set (outageMask may be NULL). the labels are held in the
+  workspace and stay valid until it is next used */
+struct components *getComponents(struct workspace *ws, struct graph *g,
+int numServers, int outageMask[]);
 
-/* finds the number of servers is the largest subnetwork */
-int getLargestSubnet(struct graph *g, int v, int visited[], int n);
+/* fills top[] with the labels of up to k of the largest subnetworks, largest
+  first and ties going to the subnetwork with the smaller server. returns the
+  number filled in */
+int topComponents(struct components *c, int k, int top[]);
 
-/* helper function for task 3. finds the servers in the largest subnetwork */
-void getservers(struct graph *g, int tempserver, int visited[]);
+/* fills histogram[s] with the number of subnetworks of s servers, for s from
+  0 to numServers. returns the size of the largest subnetwork */
+int getSizeHistogram(struct components *c, int histogram[]);
 
 /* comparison function for inbuilt qsort */
 int cmpfunc (const void * a, const void * b);
@@ -88,12 +225,50 @@ int cmpfunc (const void * a, const void * b);
 int isOut(int vertex, int outageSIDs[], int numoutages);
 
 /* implementation of dijkstra's algorithm to find the shortest path */
-void dijkstras(struct graph *g, int start, int dist[], int prev[], 
-int n, int outageSIDs[], int numoutages);
+void dijkstras(struct workspace *ws, struct graph *g, int start, int dist[],
+int prev[], int n, int outageMask[]);
+
+/* fills mask[] so that mask[v] is 1 if "v" has been affected by the outage */
+void getOutageMask(int mask[], int n, int outageSIDs[], int numoutages);
+
+/* sets mask[v] to 1 for every decommissioned server "v" */
+void maskRemoved(struct graph *g, int mask[], int n);
+
+/* dijkstra's algorithm over the edge costs using a monotone bucket queue.
+  unreachable servers are left with dist NOPATH and prev -1 */
+void weightedDijkstras(struct workspace *ws, struct graph *g, int start,
+int dist[], int prev[], int n, int outageMask[]);
+
+/* breadth first search over surviving servers from "start", filling dist[] with
+  hop counts. dist[] must be NOPATH for every server on entry, only the servers
+  reached are changed and they are left in queue[0] to queue[*reached - 1] in
+  the order found. returns the eccentricity of "start" */
+int bfsDistances(struct graph *g, int start, int dist[], int n,
+int outageMask[], int queue[], int *reached);
+
+/* finds the eccentricity of every surviving server, narrowing lower and upper
+  bounds from each traversal so that most servers are settled without a
+  traversal of their own. outaged servers get -1. returns the number of
+  traversals done */
+int getEccentricities(struct workspace *ws, struct graph *g, int ecc[], int n,
+int outageMask[]);
+
+/* finds the largest diameter of the surviving subnetworks, stopping once
+  "milliseconds" have passed. each traversal narrows bounds on eccentricities
+  as in getEccentricities, servers which can't lie on a longer path than the
+  longest found are dropped and the rest give an upper bound on the diameter.
+  fills in the longest path found, the upper bound and whether the two met */
+void getDiameterWithin(struct workspace *ws, struct graph *g, int numServers,
+int outageMask[], int milliseconds, struct solution *solution);
+
+/* fills in the radius and centre servers of the largest surviving subnetwork
+  from the eccentricities already in the solution */
+void getCentre(struct workspace *ws, struct graph *g, int numServers,
+int outageMask[], struct solution *solution);
 
 /* helper function for dijkstra's. updates cost for adjacent nodes */
 void updatecosts(struct graph *g, struct pq *priq, int u, int dist[], 
-int prev[], int outageSIDs[], int numoutages);
+int prev[], int outageMask[]);
 
 /* helper function for task 4. finds the local maximum shortest path length */
 void getLocalMax(int dist[], int prev[], int *max, int *end, int n);
@@ -107,10 +282,10 @@ void populateServers(int servers[], int finalprev[], int startserver,
 int endserver, int n);
 
 /* does DFS traversal on the graph to find the push orders and highest reachable ancestors for all nodes */
-void getOrderAndHRA(struct graph *g, int iscritical[], int u, int visited[], int order[], int hra[], int parent[], int numservers, int *count, int *crticalcount) ;
+void getOrderAndHRA(struct workspace *ws, struct graph *g, int iscritical[], int root, int visited[], int order[], int hra[], int parent[], int numservers, int *count, int *crticalcount);
 
 /* finds the minimum of the two integers provided */
 int min(int a, int b);
 
-/* finds the adjacent node of server "v" */
-int isAdjacent(struct graph *g, int i, int v);
\ No newline at end of file
+/* finds the maximum of the two integers provided */
+int max(int a, int b);
@@ -0,0 +1,430 @@
+/*
+incremental.c
+
+Union-find subnetworks and block-cut forest
+
+Implementations for keeping the subnetworks and critical servers of a network
+up to date as connections are added to it.
+*/
+#include <stdlib.h>
+#include <assert.h>
+#include "graph.h"
+#include "incremental.h"
+
+#define NOPARENT (-1)
+
+struct incremental {
+  struct graph *g;
+  int numServers;
+  /* Union-find over servers, with the size and smallest server of each
+    subnetwork kept at its representative. */
+  int *subnet;
+  int *subnetSize;
+  int *subnetMin;
+  int connectedSubnets;
+  /* Representative of the largest subnetwork, -1 if there are no servers. */
+  int largest;
+  /* Block-cut forest. serverParent holds the block above each server (any
+    block merged into it, see findBlock) and blockParent the server above
+    each block. Blocks merged together share a union-find set. */
+  int *serverParent;
+  int *blockParent;
+  int *block;
+  int *blockRank;
+  int numBlocks;
+  /* Number of blocks each server lies in. */
+  int *blockCount;
+  int criticalCount;
+  /* Marks left on forest nodes (servers then blocks) while finding the
+    lowest common ancestor of the ends of a connection. */
+  int *mark;
+  int stamp;
+  /* Lists handed back in reports. */
+  int newlyCritical[2];
+  int *noLongerCritical;
+};
+
+static int findSubnet(struct incremental *inc, int v){
+  int root = v, next;
+  while((inc->subnet)[root] != root){
+    root = (inc->subnet)[root];
+  }
+  /* Point everything on the way straight at the representative. */
+  while((inc->subnet)[v] != root){
+    next = (inc->subnet)[v];
+    (inc->subnet)[v] = root;
+    v = next;
+  }
+  return root;
+}
+
+static int findBlock(struct incremental *inc, int b){
+  int root = b, next;
+  while((inc->block)[root] != root){
+    root = (inc->block)[root];
+  }
+  while((inc->block)[b] != root){
+    next = (inc->block)[b];
+    (inc->block)[b] = root;
+    b = next;
+  }
+  return root;
+}
+
+/* Block above server v, or NOPARENT if v is the root of its tree. */
+static int blockAbove(struct incremental *inc, int v){
+  if((inc->serverParent)[v] == NOPARENT){
+    return NOPARENT;
+  }
+  (inc->serverParent)[v] = findBlock(inc, (inc->serverParent)[v]);
+  return (inc->serverParent)[v];
+}
+
+/* Returns 1 if subnetwork a should be reported before subnetwork b as the
+  largest, ties going to the one with the smaller server. */
+static int largerSubnet(struct incremental *inc, int a, int b){
+  if((inc->subnetSize)[a] != (inc->subnetSize)[b]){
+    return (inc->subnetSize)[a] > (inc->subnetSize)[b];
+  }
+  return (inc->subnetMin)[a] < (inc->subnetMin)[b];
+}
+
+/* Adds one to the blocks holding v, noting v if it becomes critical. */
+static void gainBlock(struct incremental *inc,
+  struct connectionReport *report, int v){
+  (inc->blockCount)[v]++;
+  if((inc->blockCount)[v] == 2){
+    (inc->criticalCount)++;
+    if(report){
+      report->newlyCritical[report->newlyCriticalCount++] = v;
+    }
+  }
+}
+
+/* Takes one from the blocks holding v, noting v if it stops being critical. */
+static void loseBlock(struct incremental *inc,
+  struct connectionReport *report, int v){
+  (inc->blockCount)[v]--;
+  if((inc->blockCount)[v] == 1){
+    (inc->criticalCount)--;
+    if(report){
+      report->noLongerCritical[report->noLongerCriticalCount++] = v;
+    }
+  }
+}
+
+/* Re-roots the tree holding v at v by turning round the parents on the path
+  from v to the old root. */
+static void evert(struct incremental *inc, int v){
+  int below = NOPARENT, b, next;
+  while(v != NOPARENT){
+    b = blockAbove(inc, v);
+    (inc->serverParent)[v] = below;
+    if(b == NOPARENT){
+      break;
+    }
+    next = (inc->blockParent)[b];
+    (inc->blockParent)[b] = v;
+    below = b;
+    v = next;
+  }
+}
+
+/* Joins the subnetworks of start and end with a new block holding just the
+  connection between them. */
+static void link(struct incremental *inc, struct connectionReport *report,
+  int start, int end){
+  int a = findSubnet(inc, start), b = findSubnet(inc, end), tmp, newBlock;
+  /* Re-root the smaller tree so that each server is re-rooted O(log n)
+    times. */
+  if((inc->subnetSize)[a] < (inc->subnetSize)[b]){
+    tmp = a;
+    a = b;
+    b = tmp;
+    tmp = start;
+    start = end;
+    end = tmp;
+  }
+  evert(inc, end);
+  newBlock = (inc->numBlocks)++;
+  (inc->block)[newBlock] = newBlock;
+  (inc->blockRank)[newBlock] = 0;
+  (inc->blockParent)[newBlock] = start;
+  (inc->serverParent)[end] = newBlock;
+  gainBlock(inc, report, start);
+  gainBlock(inc, report, end);
+
+  (inc->subnet)[b] = a;
+  (inc->subnetSize)[a] += (inc->subnetSize)[b];
+  if((inc->subnetMin)[b] < (inc->subnetMin)[a]){
+    (inc->subnetMin)[a] = (inc->subnetMin)[b];
+  }
+  (inc->connectedSubnets)--;
+  if(inc->largest == b || largerSubnet(inc, a, inc->largest)){
+    inc->largest = a;
+  }
+}
+
+/* Parent of a forest node, servers are numbered from 0 and blocks after
+  them. */
+static int nodeParent(struct incremental *inc, int node){
+  int b;
+  if(node < inc->numServers){
+    b = blockAbove(inc, node);
+    return b == NOPARENT ? NOPARENT : inc->numServers + b;
+  }
+  return (inc->blockParent)[node - inc->numServers];
+}
+
+/* Puts block b in the same set as merged (NOPARENT for none yet), returning
+  the set's block. */
+static int joinBlock(struct incremental *inc, int merged, int b){
+  if(merged == NOPARENT || merged == b){
+    return b;
+  }
+  if((inc->blockRank)[merged] < (inc->blockRank)[b]){
+    (inc->block)[merged] = b;
+    return b;
+  }
+  (inc->block)[b] = merged;
+  if((inc->blockRank)[merged] == (inc->blockRank)[b]){
+    (inc->blockRank)[merged]++;
+  }
+  return merged;
+}
+
+/* Returns 1 if the forest node reached is top. Once a block at the top has
+  been merged, blocks are reached by the merged block's number instead. */
+static int reachedTop(struct incremental *inc, int node, int top){
+  if(node == top){
+    return 1;
+  }
+  return node >= inc->numServers && top >= inc->numServers &&
+    node - inc->numServers == findBlock(inc, top - inc->numServers);
+}
+
+/* Merges the blocks on the forest path from server v up to (but not
+  including) top into merged, returning the merged block. Servers met on the
+  way now lie in one block fewer. */
+static int mergeUpTo(struct incremental *inc, struct connectionReport *report,
+  int v, int top, int merged){
+  int node;
+  for(node = nodeParent(inc, v); ! reachedTop(inc, node, top);
+    node = nodeParent(inc, node)){
+    if(node < inc->numServers){
+      loseBlock(inc, report, node);
+    } else {
+      merged = joinBlock(inc, merged, node - inc->numServers);
+    }
+  }
+  return merged;
+}
+
+/* Merges every block on the forest path between start and end, which are in
+  the same subnetwork, into one. */
+static void mergePath(struct incremental *inc,
+  struct connectionReport *report, int start, int end){
+  int up[2], i, top = NOPARENT, merged, topParent;
+  /* Walk up from both ends in turn, the first node reached twice is the
+    lowest common ancestor. */
+  (inc->stamp)++;
+  up[0] = start;
+  up[1] = end;
+  (inc->mark)[start] = inc->stamp;
+  (inc->mark)[end] = inc->stamp;
+  while(top == NOPARENT){
+    for(i = 0; i < 2 && top == NOPARENT; i++){
+      if(up[i] == NOPARENT){
+        continue;
+      }
+      up[i] = nodeParent(inc, up[i]);
+      if(up[i] == NOPARENT){
+        continue;
+      }
+      if((inc->mark)[up[i]] == inc->stamp){
+        top = up[i];
+      } else {
+        (inc->mark)[up[i]] = inc->stamp;
+      }
+    }
+  }
+  if(top < inc->numServers){
+    /* The path turns at a server, which is above the merged block. Unless it
+      is one of the ends, it now lies in one block fewer. */
+    topParent = top;
+    merged = NOPARENT;
+    if(top != start){
+      merged = mergeUpTo(inc, report, start, top, merged);
+    }
+    if(top != end){
+      merged = mergeUpTo(inc, report, end, top, merged);
+    }
+    if(top != start && top != end){
+      loseBlock(inc, report, top);
+    }
+  } else {
+    /* The path turns at a block, which is merged with the rest and keeps its
+      place in the forest. */
+    top -= inc->numServers;
+    topParent = (inc->blockParent)[top];
+    merged = mergeUpTo(inc, report, start, top + inc->numServers, top);
+    merged = mergeUpTo(inc, report, end, top + inc->numServers, merged);
+  }
+  (inc->blockParent)[merged] = topParent;
+}
+
+/* Adds the connection between start and end to the forest. */
+static void insert(struct incremental *inc, struct connectionReport *report,
+  int start, int end){
+  if(start == end){
+    /* A connection from a server to itself changes nothing. */
+    return;
+  }
+  if(findSubnet(inc, start) != findSubnet(inc, end)){
+    if(report){
+      report->joined = 1;
+    }
+    link(inc, report, start, end);
+  } else {
+    mergePath(inc, report, start, end);
+  }
+}
+
+struct incremental *newIncremental(struct graph *g, int numServers){
+  struct adjacency *adj = getAdjacency(g);
+  struct incremental *inc = (struct incremental *)
+    malloc(sizeof(struct incremental));
+  assert(inc);
+  int v, k, w;
+  inc->g = g;
+  inc->numServers = numServers;
+  inc->subnet = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->subnet);
+  inc->subnetSize = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->subnetSize);
+  inc->subnetMin = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->subnetMin);
+  inc->serverParent = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->serverParent);
+  /* Every block but the merged ones joins two subnetworks, so there are
+    fewer blocks than servers. */
+  inc->blockParent = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->blockParent);
+  inc->block = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->block);
+  inc->blockRank = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->blockRank);
+  inc->blockCount = (int *) calloc(numServers + 1, sizeof(int));
+  assert(inc->blockCount);
+  inc->mark = (int *) calloc(2 * numServers + 1, sizeof(int));
+  assert(inc->mark);
+  inc->noLongerCritical = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(inc->noLongerCritical);
+  inc->numBlocks = 0;
+  inc->criticalCount = 0;
+  inc->stamp = 0;
+  inc->connectedSubnets = 0;
+  inc->largest = -1;
+
+  for(v = 0; v < numServers; v++){
+    (inc->subnet)[v] = v;
+    (inc->subnetMin)[v] = v;
+    (inc->serverParent)[v] = NOPARENT;
+    /* decommissioned servers belong to no subnetwork */
+    (inc->subnetSize)[v] = isRemoved(g, v) ? 0 : 1;
+    if((inc->subnetSize)[v] > 0){
+      (inc->connectedSubnets)++;
+      if(inc->largest == -1){
+        inc->largest = v;
+      }
+    }
+  }
+  /* Each connection is in the rows of both of its ends, add it once. */
+  for(v = 0; v < numServers; v++){
+    for(k = (adj->start)[v]; k < (adj->start)[v] + (adj->len)[v]; k++){
+      w = (adj->target)[k];
+      if(w > v && w < numServers){
+        insert(inc, NULL, v, w);
+      }
+    }
+  }
+  return inc;
+}
+
+int addConnection(struct incremental *inc, int start, int end, int weight,
+  struct connectionReport *report){
+  assert(start >= 0 && start < inc->numServers);
+  assert(end >= 0 && end < inc->numServers);
+  report->joined = 0;
+  report->newlyCriticalCount = 0;
+  report->newlyCritical = inc->newlyCritical;
+  report->noLongerCriticalCount = 0;
+  report->noLongerCritical = inc->noLongerCritical;
+  if(isRemoved(inc->g, start) || isRemoved(inc->g, end)){
+    report->connectedSubnets = inc->connectedSubnets;
+    report->largestSubnet = (inc->subnetSize)[inc->largest];
+    return 0;
+  }
+  addWeightedEdge(inc->g, start, end, weight);
+  insert(inc, report, start, end);
+  report->connectedSubnets = inc->connectedSubnets;
+  report->largestSubnet = (inc->subnetSize)[inc->largest];
+  qsort(report->newlyCritical, report->newlyCriticalCount, sizeof(int),
+    cmpfunc);
+  qsort(report->noLongerCritical, report->noLongerCriticalCount, sizeof(int),
+    cmpfunc);
+  return 1;
+}
+
+struct solution *incrementalSolution(struct incremental *inc,
+  enum problemPart part){
+  struct solution *solution = (struct solution *)
+    malloc(sizeof(struct solution));
+  assert(solution);
+  int v, count = 0, largest = inc->largest;
+  initaliseSolution(solution);
+  if(part == TASK_2){
+    solution->connectedSubnets = inc->connectedSubnets;
+  } else if(part == TASK_3){
+    if(largest != -1 && (inc->subnetSize)[largest] > 0){
+      solution->largestSubnet = (inc->subnetSize)[largest];
+      solution->largestSubnetSIDs = (int *) malloc(sizeof(int) *
+        solution->largestSubnet);
+      assert(solution->largestSubnetSIDs);
+      for(v = 0; v < inc->numServers; v++){
+        if(findSubnet(inc, v) == largest && ! isRemoved(inc->g, v)){
+          (solution->largestSubnetSIDs)[count++] = v;
+        }
+      }
+    }
+  } else {
+    assert(part == TASK_7);
+    solution->criticalServerCount = inc->criticalCount;
+    solution->criticalServerSIDs = (int *) malloc(sizeof(int) *
+      (inc->criticalCount + 1));
+    assert(solution->criticalServerSIDs);
+    for(v = 0; v < inc->numServers; v++){
+      if((inc->blockCount)[v] >= 2){
+        (solution->criticalServerSIDs)[count++] = v;
+      }
+    }
+  }
+  return solution;
+}
+
+void freeIncremental(struct incremental *inc){
+  if(! inc){
+    return;
+  }
+  free(inc->subnet);
+  free(inc->subnetSize);
+  free(inc->subnetMin);
+  free(inc->serverParent);
+  free(inc->blockParent);
+  free(inc->block);
+  free(inc->blockRank);
+  free(inc->blockCount);
+  free(inc->mark);
+  free(inc->noLongerCritical);
+  free(inc);
+}
@@ -0,0 +1,54 @@
+/*
+incremental.h
+
+Visible structs and functions for keeping the subnetworks and critical servers
+of a network up to date as connections are added to it.
+
+Subnetworks are kept in a union-find structure. Critical servers come from a
+  block-cut forest: every biconnected block of the network and every server is
+  a node, servers hang below the block above them and blocks hang below the
+  server joining them to the rest of their subnetwork. A connection between
+  two subnetworks adds a new block, a connection inside a subnetwork merges the
+  blocks on the path between its ends. A server is critical while it lies in
+  two or more blocks.
+*/
+/* Because we use struct graph, struct solution and enum problemPart in this
+  file, we should include graph.h here. */
+#include "graph.h"
+
+/* Subnetworks and critical servers kept up to date for a network. */
+struct incremental;
+
+/* What changed when a connection was added. The lists are in increasing order
+  and stay valid until the next connection is added. */
+#ifndef CONNECTION_REPORT_STRUCT
+#define CONNECTION_REPORT_STRUCT
+struct connectionReport {
+  /* 1 if the connection joined two subnetworks, 0 otherwise. */
+  int joined;
+  int connectedSubnets;
+  int largestSubnet;
+  int newlyCriticalCount;
+  int *newlyCritical;
+  int noLongerCriticalCount;
+  int *noLongerCritical;
+};
+#endif
+
+/* Builds the subnetworks and block-cut forest for the connections already in
+  g between servers 0 to numServers - 1. */
+struct incremental *newIncremental(struct graph *g, int numServers);
+
+/* Adds the connection to g and updates the subnetworks and critical servers,
+  filling in report. Returns 0 if the connection was refused because one of
+  its ends is decommissioned, otherwise 1. */
+int addConnection(struct incremental *inc, int start, int end, int weight,
+  struct connectionReport *report);
+
+/* Returns the solution for Task 2, 3 or 7 from the structures kept, without
+  traversing the network. */
+struct solution *incrementalSolution(struct incremental *inc,
+  enum problemPart part);
+
+/* Frees the structures kept, but not the graph they were built for. */
+void freeIncremental(struct incremental *inc);
@@ -0,0 +1,172 @@
+/*
+mpq.c
+
+Dial's Buckets / Radix Heap Implementation
+
+Implementations for helper functions for monotone priority queue construction
+and manipulation.
+*/
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include "mpq.h"
+
+#define INITIALITEMS 32
+/* Largest edge cost for which Dial's buckets are used. */
+#define DIALMAXWEIGHT 256
+/* One bucket per bit of the priority plus one for equal priorities. */
+#define RADIXBUCKETS ((int) (sizeof(unsigned int) * CHAR_BIT) + 1)
+
+enum mpqKind {
+  DIAL=0,
+  RADIX=1
+};
+
+struct bucket {
+  int count;
+  int allocated;
+  int *items;
+  int *priorities;
+};
+
+struct mpq {
+  enum mpqKind kind;
+  int count;
+  /* Priority of the last item taken from the queue. */
+  int last;
+  int numBuckets;
+  struct bucket *buckets;
+};
+
+struct mpq *newMPQ(int maxWeight){
+  struct mpq *mpq = (struct mpq *) malloc(sizeof(struct mpq));
+  assert(mpq);
+  assert(maxWeight >= 0);
+  if(maxWeight <= DIALMAXWEIGHT){
+    mpq->kind = DIAL;
+    /* Every waiting priority is within maxWeight of the last one taken. */
+    mpq->numBuckets = maxWeight + 1;
+  } else {
+    mpq->kind = RADIX;
+    mpq->numBuckets = RADIXBUCKETS;
+  }
+  mpq->buckets = (struct bucket *) calloc(mpq->numBuckets,
+    sizeof(struct bucket));
+  assert(mpq->buckets);
+  mpq->count = 0;
+  mpq->last = 0;
+  return mpq;
+}
+
+static void bucketPush(struct bucket *b, int item, int priority){
+  if((b->count + 1) > b->allocated){
+    if(b->allocated == 0){
+      b->allocated = INITIALITEMS;
+    } else {
+      b->allocated *= 2;
+    }
+    b->items = (int *) realloc(b->items, b->allocated * sizeof(int));
+    assert(b->items);
+    b->priorities = (int *) realloc(b->priorities, b->allocated *
+      sizeof(int));
+    assert(b->priorities);
+  }
+  (b->items)[b->count] = item;
+  (b->priorities)[b->count] = priority;
+  (b->count)++;
+}
+
+/* Radix heap bucket for a priority: the position of the highest bit in which
+  it differs from the last priority taken, 0 if they are equal. */
+static int radixBucket(int last, int priority){
+  unsigned int diff = ((unsigned int) priority) ^ ((unsigned int) last);
+  int i = 0;
+  while(diff){
+    diff >>= 1;
+    i++;
+  }
+  return i;
+}
+
+void mpqEnqueue(struct mpq *mpq, int item, int priority){
+  assert(mpq);
+  assert(priority >= mpq->last);
+  if(mpq->kind == DIAL){
+    bucketPush(&(mpq->buckets)[priority % mpq->numBuckets], item, priority);
+  } else {
+    bucketPush(&(mpq->buckets)[radixBucket(mpq->last, priority)], item,
+      priority);
+  }
+  (mpq->count)++;
+}
+
+int mpqDeletemin(struct mpq *mpq, int *priority){
+  struct bucket *b;
+  int i, j, lowest;
+  if(mpq->count <= 0){
+    return -1;
+  }
+  if(mpq->kind == DIAL){
+    /* Walk the circular buckets forward from the last priority taken, all
+      items in a non-empty bucket share the same priority. */
+    while((mpq->buckets)[mpq->last % mpq->numBuckets].count == 0){
+      (mpq->last)++;
+    }
+    b = &(mpq->buckets)[mpq->last % mpq->numBuckets];
+  } else {
+    b = &(mpq->buckets)[0];
+    if(b->count == 0){
+      /* Find the first non-empty bucket and spread its items out over the
+        lower buckets relative to its smallest priority. */
+      for(i = 1; (mpq->buckets)[i].count == 0; i++);
+      b = &(mpq->buckets)[i];
+      lowest = (b->priorities)[0];
+      for(j = 1; j < b->count; j++){
+        if((b->priorities)[j] < lowest){
+          lowest = (b->priorities)[j];
+        }
+      }
+      mpq->last = lowest;
+      for(j = 0; j < b->count; j++){
+        bucketPush(&(mpq->buckets)[radixBucket(lowest, (b->priorities)[j])],
+          (b->items)[j], (b->priorities)[j]);
+      }
+      b->count = 0;
+      b = &(mpq->buckets)[0];
+    }
+  }
+  (b->count)--;
+  (mpq->count)--;
+  if(priority){
+    *priority = (b->priorities)[b->count];
+  }
+  return (b->items)[b->count];
+}
+
+int mpqEmpty(struct mpq *mpq){
+  return mpq->count == 0;
+}
+
+void resetMPQ(struct mpq *mpq){
+  int i;
+  for(i = 0; i < mpq->numBuckets; i++){
+    (mpq->buckets)[i].count = 0;
+  }
+  mpq->count = 0;
+  mpq->last = 0;
+}
+
+void freeMPQ(struct mpq *mpq){
+  int i;
+  if(! mpq){
+    return;
+  }
+  for(i = 0; i < mpq->numBuckets; i++){
+    if((mpq->buckets)[i].allocated > 0){
+      free((mpq->buckets)[i].items);
+      free((mpq->buckets)[i].priorities);
+    }
+  }
+  free(mpq->buckets);
+  free(mpq);
+}
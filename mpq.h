@@ -0,0 +1,34 @@
+/*
+mpq.h
+
+Visible structs and functions for monotone priority queues.
+
+A monotone priority queue only accepts items whose priority is no smaller than
+  the priority of the last item taken from it, which is always the case for
+  the tentative distances in dijkstra's algorithm with non-negative costs.
+  Small maximum costs use Dial's circular buckets, large maximum costs use a
+  radix heap.
+*/
+/* The monotone priority queue. */
+struct mpq;
+
+/* Get a new empty monotone priority queue for edge costs up to maxWeight. */
+struct mpq *newMPQ(int maxWeight);
+
+/* Add an item to the queue. Priority must be no smaller than the priority of
+  the last item taken from the queue. The same item may be added more than
+  once, callers should skip stale entries. */
+void mpqEnqueue(struct mpq *mpq, int item, int priority);
+
+/* Take an item with the smallest priority from the queue, storing its priority
+  in *priority. Returns -1 if the queue is empty. */
+int mpqDeletemin(struct mpq *mpq, int *priority);
+
+/* Returns 1 if empty, 0 otherwise. */
+int mpqEmpty(struct mpq *mpq);
+
+/* Remove all items from the queue so it can be used again. */
+void resetMPQ(struct mpq *mpq);
+
+/* Remove all items from the queue and free the queue. */
+void freeMPQ(struct mpq *mpq);
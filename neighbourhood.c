@@ -0,0 +1,245 @@
+/*
+neighbourhood.c
+
+k-hop neighbourhoods
+
+Implementations for a breadth first search shared between a batch of queries,
+with a block of bits per server for the queries which have reached it.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdint.h>
+#include "graph.h"
+#include "arena.h"
+#include "neighbourhood.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* 64 bit words in each server's block, one bit per query in the batch. */
+#define BLOCKWORDS (NEIGHBOURHOODBATCH / 64)
+/* How many servers ahead in the frontier to prefetch rows for. */
+#define PREFETCHDISTANCE 4
+
+/* One batch's blocks and the servers on its frontier. */
+struct batchSearch {
+  struct adjacency *adj;
+  int numServers;
+  int *outageMask;
+  /* BLOCKWORDS words per server: the queries which have reached it, the ones
+    which reached it at the last hop and the ones reaching it at this hop. */
+  uint64_t *seen;
+  uint64_t *frontier;
+  uint64_t *next;
+  /* Servers on the frontier, and the ones whose next block is filled in. */
+  int *frontierServers;
+  int numFrontier;
+  int *touched;
+  int numTouched;
+};
+
+/* to |= from over a server's block. */
+static void orBlock(uint64_t *to, const uint64_t *from){
+#if defined(__SSE2__) && BLOCKWORDS % 2 == 0
+  int i;
+  for(i = 0; i < BLOCKWORDS; i += 2){
+    __m128i a = _mm_loadu_si128((const __m128i *) &(to[i]));
+    __m128i b = _mm_loadu_si128((const __m128i *) &(from[i]));
+    _mm_storeu_si128((__m128i *) &(to[i]), _mm_or_si128(a, b));
+  }
+#else
+  int i;
+  for(i = 0; i < BLOCKWORDS; i++){
+    to[i] |= from[i];
+  }
+#endif
+}
+
+static int emptyBlock(const uint64_t *block){
+  int i;
+  for(i = 0; i < BLOCKWORDS; i++){
+    if(block[i]) return 0;
+  }
+  return 1;
+}
+
+static int skipped(struct batchSearch *s, int v){
+  return v >= s->numServers || (s->outageMask && (s->outageMask)[v]);
+}
+
+/* Adds one to the count of every query whose bit is set in block. */
+static void countBits(const uint64_t *block, int first, int reached[],
+  int stride){
+  int i, q;
+  uint64_t bits;
+  for(i = 0; i < BLOCKWORDS; i++){
+    for(bits = block[i]; bits; bits &= bits - 1){
+      q = first + 64 * i + __builtin_ctzll(bits);
+      reached[q * stride]++;
+    }
+  }
+}
+
+/* Moves the frontier of every query in the batch on by one hop, counting the
+  servers each reaches for the first time at hop. */
+static void searchHop(struct batchSearch *s, int first, int reached[],
+  int stride){
+  struct adjacency *adj = s->adj;
+  uint64_t *block, *seen;
+  int i, j, k, v, w;
+
+  s->numTouched = 0;
+  for(i = 0; i < s->numFrontier; i++){
+    v = (s->frontierServers)[i];
+    if(i + PREFETCHDISTANCE < s->numFrontier){
+      PREFETCH(&(adj->start)[(s->frontierServers)[i + PREFETCHDISTANCE]]);
+    }
+    block = &((s->frontier)[(size_t) v * BLOCKWORDS]);
+    for(k = (adj->start)[v]; k < (adj->start)[v] + (adj->len)[v]; k++){
+      w = (adj->target)[k];
+      if(skipped(s, w)) continue;
+      if(emptyBlock(&((s->next)[(size_t) w * BLOCKWORDS]))){
+        (s->touched)[s->numTouched++] = w;
+      }
+      orBlock(&((s->next)[(size_t) w * BLOCKWORDS]), block);
+    }
+  }
+  for(i = 0; i < s->numFrontier; i++){
+    v = (s->frontierServers)[i];
+    memset(&((s->frontier)[(size_t) v * BLOCKWORDS]), 0,
+      sizeof(uint64_t) * BLOCKWORDS);
+  }
+
+  /* Only the queries which hadn't reached a server before move on from it. */
+  s->numFrontier = 0;
+  for(i = 0; i < s->numTouched; i++){
+    w = (s->touched)[i];
+    block = &((s->next)[(size_t) w * BLOCKWORDS]);
+    seen = &((s->seen)[(size_t) w * BLOCKWORDS]);
+    for(j = 0; j < BLOCKWORDS; j++){
+      block[j] &= ~seen[j];
+      seen[j] |= block[j];
+    }
+    if(! emptyBlock(block)){
+      memcpy(&((s->frontier)[(size_t) w * BLOCKWORDS]), block,
+        sizeof(uint64_t) * BLOCKWORDS);
+      (s->frontierServers)[s->numFrontier++] = w;
+      countBits(block, first, reached, stride);
+    }
+    memset(block, 0, sizeof(uint64_t) * BLOCKWORDS);
+  }
+}
+
+struct neighbourhoods *getNeighbourhoods(struct graph *g, int numServers,
+  int outageMask[], int numQueries, int querySizes[], int *querySources[],
+  int maxHops, int listMembers){
+  struct neighbourhoods *n = (struct neighbourhoods *)
+    malloc(sizeof(struct neighbourhoods));
+  assert(n);
+  struct batchSearch s;
+  size_t blockBytes = sizeof(uint64_t) * BLOCKWORDS * (numServers + 1);
+  int stride = maxHops + 1, first, last, q, i, h, v, w, bit;
+  int *memberCount = NULL;
+  uint64_t *seen, bits;
+
+  n->numQueries = numQueries;
+  n->maxHops = maxHops;
+  n->reached = (int *) calloc((size_t) numQueries * stride + 1, sizeof(int));
+  assert(n->reached);
+  n->memberStart = NULL;
+  n->members = NULL;
+  if(listMembers){
+    n->memberStart = (int *) calloc(numQueries + 1, sizeof(int));
+    assert(n->memberStart);
+    memberCount = (int *) calloc(numQueries + 1, sizeof(int));
+    assert(memberCount);
+  }
+
+  s.adj = getAdjacency(g);
+  s.numServers = numServers;
+  s.outageMask = outageMask;
+  s.seen = (uint64_t *) hugeCalloc(blockBytes);
+  s.frontier = (uint64_t *) hugeCalloc(blockBytes);
+  s.next = (uint64_t *) hugeCalloc(blockBytes);
+  s.frontierServers = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(s.frontierServers);
+  s.touched = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(s.touched);
+
+  for(first = 0; first < numQueries; first += NEIGHBOURHOODBATCH){
+    last = first + NEIGHBOURHOODBATCH < numQueries ?
+      first + NEIGHBOURHOODBATCH : numQueries;
+    /* Hop 0: each query's own servers. */
+    s.numFrontier = 0;
+    for(q = first; q < last; q++){
+      bit = q - first;
+      for(i = 0; i < querySizes[q]; i++){
+        v = querySources[q][i];
+        assert(v >= 0 && v < numServers);
+        if(skipped(&s, v)) continue;
+        seen = &(s.seen[(size_t) v * BLOCKWORDS]);
+        if(seen[bit / 64] & ((uint64_t) 1 << (bit % 64))) continue;
+        if(emptyBlock(&(s.frontier[(size_t) v * BLOCKWORDS]))){
+          s.frontierServers[s.numFrontier++] = v;
+        }
+        seen[bit / 64] |= (uint64_t) 1 << (bit % 64);
+        s.frontier[(size_t) v * BLOCKWORDS + bit / 64] |=
+          (uint64_t) 1 << (bit % 64);
+        (n->reached)[q * stride]++;
+      }
+    }
+    for(h = 1; h <= maxHops && s.numFrontier > 0; h++){
+      searchHop(&s, first, &((n->reached)[h]), stride);
+    }
+    for(i = 0; i < s.numFrontier; i++){
+      v = s.frontierServers[i];
+      memset(&(s.frontier[(size_t) v * BLOCKWORDS]), 0,
+        sizeof(uint64_t) * BLOCKWORDS);
+    }
+
+    /* The seen blocks hold every query's neighbourhood, which are copied out
+      in increasing order of server before the next batch. */
+    if(listMembers){
+      for(q = first; q < last; q++){
+        for(h = 0; h <= maxHops; h++){
+          (n->memberStart)[q + 1] += (n->reached)[q * stride + h];
+        }
+        (n->memberStart)[q + 1] += (n->memberStart)[q];
+      }
+      n->members = (int *) realloc(n->members,
+        sizeof(int) * ((n->memberStart)[last] + 1));
+      assert(n->members);
+      for(v = 0; v < numServers; v++){
+        seen = &(s.seen[(size_t) v * BLOCKWORDS]);
+        for(i = 0; i < BLOCKWORDS; i++){
+          for(bits = seen[i]; bits; bits &= bits - 1){
+            q = first + 64 * i + __builtin_ctzll(bits);
+            w = (n->memberStart)[q] + memberCount[q]++;
+            (n->members)[w] = v;
+          }
+        }
+      }
+    }
+    memset(s.seen, 0, blockBytes);
+  }
+
+  hugeFree(s.seen);
+  hugeFree(s.frontier);
+  hugeFree(s.next);
+  free(s.frontierServers);
+  free(s.touched);
+  free(memberCount);
+  return n;
+}
+
+void freeNeighbourhoods(struct neighbourhoods *n){
+  if(! n){
+    return;
+  }
+  free(n->reached);
+  free(n->memberStart);
+  free(n->members);
+  free(n);
+}
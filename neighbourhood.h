@@ -0,0 +1,45 @@
+/*
+neighbourhood.h
+
+Visible structs and functions for k-hop neighbourhoods: the servers within k
+hops of a server, or of any of a set of servers, after the outage.
+
+Queries are answered NEIGHBOURHOODBATCH at a time by one breadth first search
+  shared between them. Each server keeps a block of bits, one per query, for
+  the queries which have reached it and the ones which reached it at the last
+  hop, so a hop from a server passes on every query's frontier with a few
+  word-wide ORs.
+*/
+/* Because we use struct graph in this file, we should include graph.h here. */
+#include "graph.h"
+
+/* Queries searched together, one bit each. */
+#define NEIGHBOURHOODBATCH 128
+
+/* The servers reached by every query, hop by hop. */
+#ifndef NEIGHBOURHOODS_STRUCT
+#define NEIGHBOURHOODS_STRUCT
+struct neighbourhoods {
+  int numQueries;
+  int maxHops;
+  /* Servers first reached by query q at hop h are counted in
+    reached[q * (maxHops + 1) + h]. Hop 0 counts the query's own servers. */
+  int *reached;
+  /* If listed, the servers within maxHops of query q are
+    members[memberStart[q]] to members[memberStart[q + 1] - 1] in increasing
+    order, otherwise both are NULL. */
+  int *memberStart;
+  int *members;
+};
+#endif
+
+/* Finds the servers within maxHops of each of numQueries queries, skipping
+  those in outageMask (which may be NULL). Query q starts from the
+  querySizes[q] servers in querySources[q]; any in the outage are left out.
+  The servers reached are listed if listMembers is 1. */
+struct neighbourhoods *getNeighbourhoods(struct graph *g, int numServers,
+  int outageMask[], int numQueries, int querySizes[], int *querySources[],
+  int maxHops, int listMembers);
+
+/* Frees all memory used by n. */
+void freeNeighbourhoods(struct neighbourhoods *n);
@@ -19,6 +19,9 @@ struct pq {
   int allocated;
   int *queue;
   int *priorities;
+  /* Where each item is in the queue (-1 if absent), only for indexed queues. */
+  int numItems;
+  int *position;
 };
 
 
@@ -29,6 +32,25 @@ struct pq *newPQ(){
   pq->allocated = 0;
   pq->queue = NULL;
   pq->priorities = NULL;
+  pq->numItems = 0;
+  pq->position = NULL;
+  return pq;
+}
+
+struct pq *newIndexedPQ(int numItems){
+  int i;
+  struct pq *pq = newPQ();
+  pq->allocated = numItems > 0 ? numItems : 1;
+  pq->queue = (int *) malloc(pq->allocated * sizeof(int));
+  assert(pq->queue);
+  pq->priorities = (int *) malloc(pq->allocated * sizeof(int));
+  assert(pq->priorities);
+  pq->numItems = numItems;
+  pq->position = (int *) malloc(pq->allocated * sizeof(int));
+  assert(pq->position);
+  for(i = 0; i < numItems; i++){
+    (pq->position)[i] = -1;
+  }
   return pq;
 }
 
@@ -48,6 +70,10 @@ void enqueue(struct pq *pq, int item, int priority){
   }
   (pq->queue)[pq->count] = item;
   (pq->priorities)[pq->count] = priority;
+  if(pq->position){
+    assert(item >= 0 && item < pq->numItems);
+    (pq->position)[item] = pq->count;
+  }
   (pq->count)++;
 }
 
@@ -55,6 +81,9 @@ void enqueue(struct pq *pq, int item, int priority){
 int pqhasnode(struct pq *pq, int node)
 {
     int i;
+    if (pq->position) {
+      return node >= 0 && node < pq->numItems && (pq->position)[node] != -1;
+    }
     for (i = 0; i < pq->count; i++)
     {
         if ((pq->queue)[i] == node) {
@@ -84,6 +113,10 @@ int deletemin(struct pq *pq){
     (pq->priorities)[lowestElement] = (pq->priorities)[pq->count - 1];
     (pq->queue)[lowestElement] = (pq->queue)[pq->count - 1];
     (pq->count)--;
+    if(pq->position){
+      (pq->position)[(pq->queue)[lowestElement]] = lowestElement;
+      (pq->position)[returnVal] = -1;
+    }
   }
   return returnVal;
 }
@@ -92,6 +125,12 @@ int deletemin(struct pq *pq){
 void updatecost(struct pq *pq, int node, int newcost)
 {
     int i;
+    if (pq->position) {
+      if (pqhasnode(pq, node)) {
+        (pq->priorities)[(pq->position)[node]] = newcost;
+      }
+      return;
+    }
     for (i = 0; i < pq->count; i++)
     {
         if ((pq->queue)[i] == node) {
@@ -104,6 +143,16 @@ int empty(struct pq *pq){
   return pq->count == 0;
 }
 
+void clearPQ(struct pq *pq){
+  int i;
+  if(pq->position){
+    for(i = 0; i < pq->count; i++){
+      (pq->position)[(pq->queue)[i]] = -1;
+    }
+  }
+  pq->count = 0;
+}
+
 void freePQ(struct pq *pq){
   if(! pq) {
     return;
@@ -112,5 +161,8 @@ void freePQ(struct pq *pq){
     free(pq->queue);
     free(pq->priorities);
   }
+  if(pq->position){
+    free(pq->position);
+  }
   free(pq);
 }
\ No newline at end of file
@@ -11,6 +11,11 @@ struct pq;
 /* Get a new empty priority queue. */
 struct pq *newPQ();
 
+/* Get a new empty priority queue with space for items 0 to numItems - 1, each
+  held at most once, which keeps track of where each item is so checking for
+  and updating an item takes constant time. */
+struct pq *newIndexedPQ(int numItems);
+
 /* Add an item to the priority queue - cast pointer to (void *). */
 void enqueue(struct pq *pq, int item, int priority);
 
@@ -27,5 +32,8 @@ void updatecost(struct pq *pq, int node, int newcost);
 /* Returns 1 if empty, 0 otherwise. */
 int empty(struct pq *pq);
 
+/* Remove all items from priority queue so it can be used again. */
+void clearPQ(struct pq *pq);
+
 /* Remove all items from priority queue (doesn't free) and free the queue. */
 void freePQ(struct pq *pq);
@@ -0,0 +1,271 @@
+/*
+resilience.c
+
+Monte Carlo simulation of random failures
+
+Implementations for running trials of random failures split between threads,
+counting subnetworks with a union-find and finding each diameter with the
+bounds used by getDiameterWithin.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include "graph.h"
+#include "resilience.h"
+
+/* One thread's share of the trials, and its own scratch space. */
+struct resilienceThread {
+  pthread_t thread;
+  struct graph *g;
+  struct adjacency *adj;
+  int numServers;
+  enum failureModel model;
+  double level;
+  unsigned int seed;
+  struct resilience *r;
+  /* Trials first, first + step, ... are this thread's. */
+  int first;
+  int step;
+  /* Servers surviving the outage, in increasing order. */
+  int *survivors;
+  int numSurvivors;
+  /* The outage mask, copied into failed at the start of every trial. */
+  int *outageMask;
+  int *failed;
+  /* Survivors reordered as failures are picked. */
+  int *picks;
+  /* Union-find over the servers left. */
+  int *parent;
+  int *size;
+  struct workspace *ws;
+};
+
+/* Steps a splitmix64 stream, returning its next value. */
+static unsigned long long nextRandom(unsigned long long *state){
+  unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/* A uniform double in [0, 1) from the top 53 bits of the stream. */
+static double nextUniform(unsigned long long *state){
+  return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int findRoot(int parent[], int v){
+  /* Path halving. */
+  while(parent[v] != v){
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+/* Marks the servers which fail in this trial in t->failed. */
+static void failServers(struct resilienceThread *t, unsigned long long *state){
+  int i, j, swap, count;
+  memcpy(t->failed, t->outageMask, sizeof(int) * t->numServers);
+  if(t->model == FAILURE_PROBABILITY){
+    for(i = 0; i < t->numSurvivors; i++){
+      if(nextUniform(state) < t->level){
+        (t->failed)[(t->survivors)[i]] = 1;
+      }
+    }
+    return;
+  }
+  count = (int) t->level;
+  if(count > t->numSurvivors){
+    count = t->numSurvivors;
+  }
+  /* Partial Fisher-Yates shuffle, starting from the same order every trial
+    so the picks only depend on the trial's stream. */
+  memcpy(t->picks, t->survivors, sizeof(int) * t->numSurvivors);
+  for(i = 0; i < count; i++){
+    j = i + (int) (nextRandom(state) %
+      (unsigned long long) (t->numSurvivors - i));
+    swap = (t->picks)[i];
+    (t->picks)[i] = (t->picks)[j];
+    (t->picks)[j] = swap;
+    (t->failed)[(t->picks)[i]] = 1;
+  }
+}
+
+/* Counts the subnetworks left after the trial's failures and the size of the
+  largest. */
+static void countSubnets(struct resilienceThread *t, int *connectedSubnets,
+  int *largestSubnet){
+  struct adjacency *adj = t->adj;
+  int *parent = t->parent, *size = t->size, *failed = t->failed;
+  int i, k, u, w, a, b;
+  *connectedSubnets = 0;
+  *largestSubnet = 0;
+  for(i = 0; i < t->numSurvivors; i++){
+    u = (t->survivors)[i];
+    parent[u] = u;
+    size[u] = 1;
+  }
+  for(i = 0; i < t->numSurvivors; i++){
+    u = (t->survivors)[i];
+    if(failed[u]) continue;
+    for(k = (adj->start)[u]; k < (adj->start)[u] + (adj->len)[u]; k++){
+      w = (adj->target)[k];
+      /* Each connection is joined from its smaller end. */
+      if(w <= u || w >= t->numServers || failed[w]) continue;
+      a = findRoot(parent, u);
+      b = findRoot(parent, w);
+      if(a == b) continue;
+      /* Union by size. */
+      if(size[a] < size[b]){
+        parent[a] = b;
+        size[b] += size[a];
+      } else {
+        parent[b] = a;
+        size[a] += size[b];
+      }
+    }
+  }
+  for(i = 0; i < t->numSurvivors; i++){
+    u = (t->survivors)[i];
+    if(failed[u] || parent[u] != u) continue;
+    (*connectedSubnets)++;
+    if(size[u] > *largestSubnet){
+      *largestSubnet = size[u];
+    }
+  }
+}
+
+static void *resilienceWorker(void *arg){
+  struct resilienceThread *t = (struct resilienceThread *) arg;
+  struct resilience *r = t->r;
+  struct solution solution;
+  unsigned long long state;
+  int i;
+  for(i = t->first; i < r->trials; i += t->step){
+    /* Each trial's stream starts from the seed and its number alone. */
+    state = ((unsigned long long) t->seed << 32) ^ (unsigned long long) i;
+    nextRandom(&state);
+    failServers(t, &state);
+    countSubnets(t, &((r->connectedSubnets)[i]), &((r->largestSubnet)[i]));
+    memset(&solution, 0, sizeof(struct solution));
+    getDiameterWithin(t->ws, t->g, t->numServers, t->failed, INT_MAX,
+      &solution);
+    (r->diameter)[i] = solution.postOutageDiameter;
+    free(solution.postOutageDiameterSIDs);
+  }
+  return NULL;
+}
+
+struct resilience *simulateFailures(struct graph *g, int numServers,
+  int outageMask[], enum failureModel model, double level, int trials,
+  int numThreads, unsigned int seed){
+  struct resilience *r = (struct resilience *)
+    malloc(sizeof(struct resilience));
+  assert(r);
+  /* Built before the threads start, as they only read it. */
+  struct adjacency *adj = getAdjacency(g);
+  int i, v, numSurvivors = 0;
+
+  r->trials = trials;
+  r->largestSubnet = (int *) malloc(sizeof(int) * (trials + 1));
+  assert(r->largestSubnet);
+  r->connectedSubnets = (int *) malloc(sizeof(int) * (trials + 1));
+  assert(r->connectedSubnets);
+  r->diameter = (int *) malloc(sizeof(int) * (trials + 1));
+  assert(r->diameter);
+  int *mask = (int *) calloc(numServers + 1, sizeof(int));
+  assert(mask);
+  int *survivors = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(survivors);
+  for(v = 0; v < numServers; v++){
+    if(outageMask && outageMask[v]){
+      mask[v] = 1;
+    } else {
+      survivors[numSurvivors++] = v;
+    }
+  }
+
+  if(numThreads > trials){
+    numThreads = trials;
+  }
+  if(numThreads < 1){
+    numThreads = 1;
+  }
+  struct resilienceThread *threads = (struct resilienceThread *)
+    malloc(sizeof(struct resilienceThread) * numThreads);
+  assert(threads);
+  for(i = 0; i < numThreads; i++){
+    threads[i].g = g;
+    threads[i].adj = adj;
+    threads[i].numServers = numServers;
+    threads[i].model = model;
+    threads[i].level = level;
+    threads[i].seed = seed;
+    threads[i].r = r;
+    threads[i].first = i;
+    threads[i].step = numThreads;
+    threads[i].survivors = survivors;
+    threads[i].numSurvivors = numSurvivors;
+    threads[i].outageMask = mask;
+    threads[i].failed = (int *) malloc(sizeof(int) * (numServers + 1));
+    assert(threads[i].failed);
+    threads[i].picks = (int *) malloc(sizeof(int) * (numServers + 1));
+    assert(threads[i].picks);
+    threads[i].parent = (int *) malloc(sizeof(int) * (numServers + 1));
+    assert(threads[i].parent);
+    threads[i].size = (int *) malloc(sizeof(int) * (numServers + 1));
+    assert(threads[i].size);
+    threads[i].ws = newWorkspace(numServers);
+    assert(pthread_create(&(threads[i].thread), NULL, resilienceWorker,
+      &(threads[i])) == 0);
+  }
+  for(i = 0; i < numThreads; i++){
+    assert(pthread_join(threads[i].thread, NULL) == 0);
+    free(threads[i].failed);
+    free(threads[i].picks);
+    free(threads[i].parent);
+    free(threads[i].size);
+    freeWorkspace(threads[i].ws);
+  }
+  free(threads);
+  free(survivors);
+  free(mask);
+
+  qsort(r->largestSubnet, trials, sizeof(int), cmpfunc);
+  qsort(r->connectedSubnets, trials, sizeof(int), cmpfunc);
+  qsort(r->diameter, trials, sizeof(int), cmpfunc);
+  return r;
+}
+
+int resiliencePercentile(int results[], int trials, int percent){
+  int rank = (trials * percent + 99) / 100;
+  if(trials < 1){
+    return 0;
+  }
+  if(rank < 1){
+    rank = 1;
+  }
+  return results[rank - 1];
+}
+
+double resilienceMean(int results[], int trials){
+  double total = 0;
+  int i;
+  for(i = 0; i < trials; i++){
+    total += results[i];
+  }
+  return trials > 0 ? total / trials : 0;
+}
+
+void freeResilience(struct resilience *r){
+  if(! r){
+    return;
+  }
+  free(r->largestSubnet);
+  free(r->connectedSubnets);
+  free(r->diameter);
+  free(r);
+}
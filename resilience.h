@@ -0,0 +1,58 @@
+/*
+resilience.h
+
+Visible structs and functions for simulating random failures on top of the
+outage: how large the biggest subnetwork stays and how far apart its servers
+get when servers fail at random.
+
+Each trial fails servers either independently with a given probability or by
+  picking a given number of them. The subnetworks left are counted with a
+  union-find over the connections, and the diameter is found with the bounds
+  used by getDiameterWithin. Trials are split between threads, each with its
+  own workspace and scratch space. Every trial draws from its own random
+  stream, seeded from the seed and the trial's number, so the results are the
+  same for any number of threads.
+*/
+/* Because we use struct graph in this file, we should include graph.h here. */
+#include "graph.h"
+
+/* How servers fail in each trial. */
+#ifndef FAILURE_MODEL_ENUM
+#define FAILURE_MODEL_ENUM
+enum failureModel {
+  /* Every surviving server fails independently with probability level. */
+  FAILURE_PROBABILITY=0,
+  /* level surviving servers, picked at random, fail. */
+  FAILURE_COUNT=1
+};
+#endif
+
+/* The results of every trial for one failure level, each sorted. */
+#ifndef RESILIENCE_STRUCT
+#define RESILIENCE_STRUCT
+struct resilience {
+  int trials;
+  /* Servers in the largest subnetwork left. */
+  int *largestSubnet;
+  /* Subnetworks left, not counting servers which failed. */
+  int *connectedSubnets;
+  /* Longest shortest path in any subnetwork left. */
+  int *diameter;
+};
+#endif
+
+/* Runs trials random failures of the servers not in outageMask (which may be
+  NULL) with numThreads threads. */
+struct resilience *simulateFailures(struct graph *g, int numServers,
+  int outageMask[], enum failureModel model, double level, int trials,
+  int numThreads, unsigned int seed);
+
+/* Returns the nearest rank percentile of the sorted results of trials
+  trials. */
+int resiliencePercentile(int results[], int trials, int percent);
+
+/* Returns the mean of the results of trials trials. */
+double resilienceMean(int results[], int trials);
+
+/* Frees all memory used by r. */
+void freeResilience(struct resilience *r);
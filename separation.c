@@ -0,0 +1,497 @@
+/*
+separation.c
+
+Separation pairs
+
+Implementations for finding the pairs of servers whose joint failure
+disconnects their subnetwork, one depth first search per server.
+
+Both servers of a separation pair lie in the same biconnected block, so the
+network is first split into its blocks, giving every server a node in each
+block it lies in, and each search only covers the block of the server left
+out. Every node stands in for the parts of the network hanging off its server
+outside the block, so the sizes of the pieces left are still exact.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "graph.h"
+#include "separation.h"
+
+/* Room for pairs first allocated by each thread. */
+#define INITIALPAIRS 64
+
+/* Rows of a graph, the neighbours of v are target[start[v]] to
+  target[start[v] + len[v] - 1]. Searches pass over the vertices set in skip,
+  which may be NULL. */
+struct rows {
+  int numVertices;
+  int *start;
+  int *len;
+  int *target;
+  int *skip;
+};
+
+/* The network left after the outage, shared by every thread. */
+struct network {
+  int numServers;
+  /* Per server, whether it is critical. */
+  int *critical;
+  /* Subnetwork of every server, the number of them, the largest and the size
+    of the two largest (0 if there aren't that many). */
+  int *label;
+  int connectedSubnets;
+  int largest;
+  int largestSize;
+  int secondSize;
+  /* The blocks, with a node for every server in each block it lies in and
+    connections only within blocks. */
+  struct rows blocks;
+  /* Server of each node and the servers in the network it stands in for. */
+  int *server;
+  int *weight;
+  /* The only node of each server which isn't critical, -1 for servers in no
+    block. */
+  int *node;
+};
+
+/* What a depth first search keeps for each vertex, together so that reaching
+  a vertex touches a single cache line. */
+struct searchVertex {
+  /* Equal to the search's stamp once reached in the current search. */
+  int seen;
+  int disc;
+  int low;
+  int parent;
+  /* Next entry in the vertex's row to look at. */
+  int next;
+  /* Weight of the vertex, and with its subtree. */
+  int weight;
+  int subtree;
+  /* The children whose subtrees it cuts off, their total weight and the
+    largest of them. */
+  int cutCount;
+  int cutTotal;
+  int cutLargest;
+};
+
+/* Scratch space for a depth first search. */
+struct search {
+  struct searchVertex *v;
+  int stamp;
+  int *stack;
+  /* Vertices reached, in the order they were reached. */
+  int *order;
+  int reached;
+};
+
+/* One thread's share of the servers, and the pairs it has found. */
+struct separationThread {
+  pthread_t thread;
+  struct network *net;
+  struct search search;
+  int first;
+  int step;
+  int count;
+  int allocated;
+  struct separationPair *pairs;
+};
+
+static void newSearch(struct search *s, int numVertices){
+  int size = numVertices + 1;
+  s->v = (struct searchVertex *) calloc(size, sizeof(struct searchVertex));
+  assert(s->v);
+  s->stamp = 0;
+  s->stack = (int *) malloc(sizeof(int) * size);
+  assert(s->stack);
+  s->order = (int *) malloc(sizeof(int) * size);
+  assert(s->order);
+}
+
+static void freeSearch(struct search *s){
+  free(s->v);
+  free(s->stack);
+  free(s->order);
+}
+
+static void reach(struct rows *g, struct search *s, int v, int parent,
+  int weight){
+  struct searchVertex *sv = &(s->v[v]);
+  sv->seen = s->stamp;
+  sv->disc = s->reached;
+  sv->low = s->reached;
+  sv->parent = parent;
+  sv->next = (g->start)[v];
+  sv->weight = weight;
+  sv->subtree = weight;
+  sv->cutCount = 0;
+  sv->cutTotal = 0;
+  sv->cutLargest = 0;
+  s->order[s->reached++] = v;
+}
+
+/* Depth first search of g from root without the excluded vertex (-1 for
+  none), filling in the subtrees each vertex cuts off. Vertices weigh 1 if
+  weight is NULL. The search must have a new stamp. */
+static void cutSearch(struct rows *g, struct search *s, int root,
+  int excluded, int *weight){
+  int top = 0, v, w;
+  struct searchVertex *sv, *sw, *sp;
+  s->reached = 0;
+  reach(g, s, root, -1, weight ? weight[root] : 1);
+  s->stack[top++] = root;
+  while(top > 0){
+    v = s->stack[top - 1];
+    sv = &(s->v[v]);
+    if(sv->next < (g->start)[v] + (g->len)[v]){
+      w = (g->target)[(sv->next)++];
+      if(w >= g->numVertices || w == excluded || (g->skip && (g->skip)[w])){
+        continue;
+      }
+      sw = &(s->v[w]);
+      if(sw->seen != s->stamp){
+        reach(g, s, w, v, weight ? weight[w] : 1);
+        s->stack[top++] = w;
+      } else if(w != sv->parent && sw->disc < sv->low){
+        sv->low = sw->disc;
+      }
+      continue;
+    }
+    top--;
+    if(sv->parent == -1) continue;
+    sp = &(s->v[sv->parent]);
+    if(sv->low < sp->low){
+      sp->low = sv->low;
+    }
+    sp->subtree += sv->subtree;
+    if(sv->low >= sp->disc){
+      (sp->cutCount)++;
+      sp->cutTotal += sv->subtree;
+      if(sv->subtree > sp->cutLargest){
+        sp->cutLargest = sv->subtree;
+      }
+    }
+  }
+}
+
+/* Returns whether v, reached in the last search from root, splits what was
+  reached, giving the number of extra pieces and the weight of the largest. */
+static int splits(struct search *s, int root, int v, int *extraPieces,
+  int *largestPiece){
+  struct searchVertex *sv = &(s->v[v]);
+  int rest;
+  if(v == root){
+    /* Every child of the root is cut off from the others. */
+    *extraPieces = sv->cutCount - 1;
+    *largestPiece = sv->cutLargest;
+    return sv->cutCount >= 2;
+  }
+  rest = s->v[root].subtree - sv->weight - sv->cutTotal;
+  *extraPieces = sv->cutCount;
+  *largestPiece = rest > sv->cutLargest ? rest : sv->cutLargest;
+  return sv->cutCount >= 1;
+}
+
+static void addPair(struct separationThread *t, int x, int y, int subnets,
+  int largest){
+  if(t->count == t->allocated){
+    t->allocated = t->allocated > 0 ? 2 * t->allocated : INITIALPAIRS;
+    t->pairs = (struct separationPair *) realloc(t->pairs,
+      sizeof(struct separationPair) * t->allocated);
+    assert(t->pairs);
+  }
+  (t->pairs)[t->count].first = x;
+  (t->pairs)[t->count].second = y;
+  (t->pairs)[t->count].connectedSubnets = subnets;
+  (t->pairs)[t->count].largestSubnet = largest;
+  (t->count)++;
+}
+
+/* Finds the servers after x which form a separation pair with it. */
+static void pairsWith(struct separationThread *t, int x){
+  struct network *net = t->net;
+  struct rows *blocks = &(net->blocks);
+  struct search *s = &(t->search);
+  int node = (net->node)[x], root, i, y, extra, piece, other;
+  if(node == -1){
+    return;
+  }
+  /* The rest of the block, and so of the subnetwork, stays in one piece. */
+  root = (blocks->target)[(blocks->start)[node]];
+  (s->stamp)++;
+  cutSearch(blocks, s, root, node, net->weight);
+  /* The largest subnetwork which doesn't have x in it. */
+  other = (net->label)[x] == net->largest ? net->secondSize :
+    net->largestSize;
+  for(i = 0; i < s->reached; i++){
+    y = (net->server)[s->order[i]];
+    if(y <= x || (net->critical)[y] ||
+      ! splits(s, root, s->order[i], &extra, &piece)){
+      continue;
+    }
+    addPair(t, x, y, net->connectedSubnets + extra,
+      piece > other ? piece : other);
+  }
+}
+
+static void *separationWorker(void *arg){
+  struct separationThread *t = (struct separationThread *) arg;
+  int x;
+  for(x = t->first; x < t->net->numServers; x += t->step){
+    if(! (t->net->critical)[x]){
+      pairsWith(t, x);
+    }
+  }
+  return NULL;
+}
+
+/* Labels the subnetworks of the network without its decommissioned servers
+  and those in outageMask (which may be NULL), finds the critical servers and
+  splits the network into blocks. */
+static void surveyNetwork(struct network *net, struct graph *g,
+  int outageMask[]){
+  struct adjacency *adj = getAdjacency(g);
+  struct rows servers;
+  struct search s;
+  struct rows *blocks = &(net->blocks);
+  int n = net->numServers, size = n > 0 ? n : 1;
+  int v, w, u, i, pass, b, extra, piece, numNodes = 0;
+  /* Blocks are numbered by the server the search first entered them
+    through. Per server, the block it lies below the top of (-1 for none) and
+    the servers it stands in for there. Per block, its top server, the
+    servers the top stands in for and the top's node. */
+  int *block = (int *) malloc(sizeof(int) * size);
+  assert(block);
+  int *below = (int *) malloc(sizeof(int) * size);
+  assert(below);
+  int *top = (int *) malloc(sizeof(int) * size);
+  assert(top);
+  int *topWeight = (int *) malloc(sizeof(int) * size);
+  assert(topWeight);
+  int *topNode = (int *) malloc(sizeof(int) * size);
+  assert(topNode);
+  /* Rows without decommissioned servers or those in the outage. */
+  int *len = (int *) malloc(sizeof(int) * size);
+  assert(len);
+  int *leftOut = (int *) malloc(sizeof(int) * size);
+  assert(leftOut);
+
+  servers.numVertices = n;
+  servers.start = adj->start;
+  servers.len = len;
+  servers.target = adj->target;
+  servers.skip = leftOut;
+  for(v = 0; v < n; v++){
+    leftOut[v] = isRemoved(g, v) || (outageMask && outageMask[v]);
+    len[v] = leftOut[v] ? 0 : (adj->len)[v];
+    (net->critical)[v] = 0;
+    block[v] = -1;
+  }
+
+  net->connectedSubnets = 0;
+  net->largest = -1;
+  net->largestSize = 0;
+  net->secondSize = 0;
+  newSearch(&s, n);
+  s.stamp = 1;
+  for(v = 0; v < n; v++){
+    if(leftOut[v] || s.v[v].seen == s.stamp) continue;
+    cutSearch(&servers, &s, v, -1, NULL);
+    for(i = 0; i < s.reached; i++){
+      w = s.order[i];
+      (net->label)[w] = net->connectedSubnets;
+      (net->critical)[w] = splits(&s, v, w, &extra, &piece);
+      /* The blocks cut off below a server hang off it. */
+      below[w] = 1 + s.v[w].cutTotal;
+      if(w == v) continue;
+      /* Parents are reached first, so their block is known. */
+      if(s.v[w].low >= s.v[s.v[w].parent].disc){
+        block[w] = w;
+        top[w] = s.v[w].parent;
+        topWeight[w] = s.reached - s.v[w].subtree;
+      } else {
+        block[w] = block[s.v[w].parent];
+      }
+    }
+    /* Ties go to the subnetwork with the smaller server. */
+    if(s.reached > net->largestSize){
+      net->secondSize = net->largestSize;
+      net->largestSize = s.reached;
+      net->largest = net->connectedSubnets;
+    } else if(s.reached > net->secondSize){
+      net->secondSize = s.reached;
+    }
+    (net->connectedSubnets)++;
+  }
+  freeSearch(&s);
+
+  /* A node for the top of each block and for each server in the block it lies
+    below. */
+  for(v = 0; v < n; v++){
+    (net->node)[v] = -1;
+    if(block[v] == v){
+      topNode[v] = numNodes++;
+    }
+    if(block[v] != -1){
+      (net->node)[v] = numNodes++;
+    }
+  }
+  blocks->numVertices = numNodes;
+  blocks->skip = NULL;
+  blocks->start = (int *) calloc(numNodes + 1, sizeof(int));
+  assert(blocks->start);
+  blocks->len = (int *) calloc(numNodes + 1, sizeof(int));
+  assert(blocks->len);
+  net->server = (int *) malloc(sizeof(int) * (numNodes + 1));
+  assert(net->server);
+  net->weight = (int *) malloc(sizeof(int) * (numNodes + 1));
+  assert(net->weight);
+  for(v = 0; v < n; v++){
+    if(block[v] == v){
+      (net->server)[topNode[v]] = top[v];
+      (net->weight)[topNode[v]] = topWeight[v];
+    }
+    if(block[v] != -1){
+      (net->server)[(net->node)[v]] = v;
+      (net->weight)[(net->node)[v]] = below[v];
+    }
+  }
+
+  /* Each connection lies in the block of an end which lies below the top of
+    the block. Count the entries first, then fill them in. */
+  blocks->target = NULL;
+  for(pass = 0; pass < 2; pass++){
+    if(pass == 1){
+      for(u = 0; u < numNodes; u++){
+        (blocks->start)[u + 1] = (blocks->start)[u] + (blocks->len)[u];
+        (blocks->len)[u] = 0;
+      }
+      blocks->target = (int *) malloc(sizeof(int) *
+        ((blocks->start)[numNodes] + 1));
+      assert(blocks->target);
+    }
+    for(v = 0; v < n; v++){
+      for(i = (adj->start)[v]; i < (adj->start)[v] + len[v]; i++){
+        w = (adj->target)[i];
+        if(w >= n || w == v || leftOut[w]) continue;
+        b = block[v];
+        if(b == -1 || (block[w] != b && top[b] != w)){
+          b = block[w];
+        }
+        u = top[b] == v ? topNode[b] : (net->node)[v];
+        if(pass == 1){
+          (blocks->target)[(blocks->start)[u] + (blocks->len)[u]] =
+            top[b] == w ? topNode[b] : (net->node)[w];
+        }
+        ((blocks->len)[u])++;
+      }
+    }
+  }
+
+  /* The first server searched from in a subnetwork isn't critical only if it
+    tops a single block, where its node is. */
+  for(v = 0; v < n; v++){
+    if(block[v] == v && ! (net->critical)[top[v]]){
+      (net->node)[top[v]] = topNode[v];
+    }
+  }
+
+  free(block);
+  free(below);
+  free(top);
+  free(topWeight);
+  free(topNode);
+  free(len);
+  free(leftOut);
+}
+
+static int cmpPairs(const void *a, const void *b){
+  const struct separationPair *p = (const struct separationPair *) a;
+  const struct separationPair *q = (const struct separationPair *) b;
+  if(p->first != q->first){
+    return p->first - q->first;
+  }
+  return p->second - q->second;
+}
+
+struct separationPairs *getSeparationPairs(struct graph *g, int numServers,
+  int outageMask[], int numThreads){
+  struct separationPairs *result = (struct separationPairs *)
+    malloc(sizeof(struct separationPairs));
+  assert(result);
+  struct network net;
+  int i, size = numServers > 0 ? numServers : 1;
+
+  net.numServers = numServers;
+  net.critical = (int *) malloc(sizeof(int) * size);
+  assert(net.critical);
+  net.label = (int *) malloc(sizeof(int) * size);
+  assert(net.label);
+  net.node = (int *) malloc(sizeof(int) * size);
+  assert(net.node);
+  surveyNetwork(&net, g, outageMask);
+
+  if(numThreads > numServers){
+    numThreads = numServers;
+  }
+  if(numThreads < 1){
+    numThreads = 1;
+  }
+  struct separationThread *threads = (struct separationThread *)
+    malloc(sizeof(struct separationThread) * numThreads);
+  assert(threads);
+  for(i = 0; i < numThreads; i++){
+    threads[i].net = &net;
+    threads[i].first = i;
+    threads[i].step = numThreads;
+    threads[i].count = 0;
+    threads[i].allocated = 0;
+    threads[i].pairs = NULL;
+    newSearch(&(threads[i].search), net.blocks.numVertices);
+    assert(pthread_create(&(threads[i].thread), NULL, separationWorker,
+      &(threads[i])) == 0);
+  }
+
+  result->count = 0;
+  for(i = 0; i < numThreads; i++){
+    assert(pthread_join(threads[i].thread, NULL) == 0);
+    result->count += threads[i].count;
+  }
+  result->pairs = (struct separationPair *)
+    malloc(sizeof(struct separationPair) * (result->count > 0 ?
+      result->count : 1));
+  assert(result->pairs);
+  result->count = 0;
+  for(i = 0; i < numThreads; i++){
+    if(threads[i].count > 0){
+      memcpy(result->pairs + result->count, threads[i].pairs,
+        sizeof(struct separationPair) * threads[i].count);
+      result->count += threads[i].count;
+    }
+    free(threads[i].pairs);
+    freeSearch(&(threads[i].search));
+  }
+  qsort(result->pairs, result->count, sizeof(struct separationPair),
+    cmpPairs);
+
+  free(threads);
+  free(net.critical);
+  free(net.label);
+  free(net.node);
+  free(net.server);
+  free(net.weight);
+  free(net.blocks.start);
+  free(net.blocks.len);
+  free(net.blocks.target);
+  return result;
+}
+
+void freeSeparationPairs(struct separationPairs *pairs){
+  if(! pairs){
+    return;
+  }
+  free(pairs->pairs);
+  free(pairs);
+}
@@ -0,0 +1,46 @@
+/*
+separation.h
+
+Visible structs and functions for separation pairs: pairs of servers, neither
+of them critical on its own, which disconnect their subnetwork when both fail
+after the outage.
+
+The network is first split into its biconnected blocks, as both servers of
+  a pair lie in the same block. For each server x which isn't critical, the
+  articulation points of x's block without x are found with a depth first
+  search of that block alone. Every one of them forms a separation pair with
+  x. The servers are split between threads, each with its own scratch space.
+*/
+/* Because we use struct graph in this file, we should include graph.h here. */
+#include "graph.h"
+
+/* One separation pair and the network left without it. */
+#ifndef SEPARATION_PAIR_STRUCT
+#define SEPARATION_PAIR_STRUCT
+struct separationPair {
+  /* first < second. */
+  int first;
+  int second;
+  /* Subnetworks in the whole network once both fail, and the largest. */
+  int connectedSubnets;
+  int largestSubnet;
+};
+#endif
+
+/* Every separation pair, ordered by first then second server. */
+#ifndef SEPARATION_PAIRS_STRUCT
+#define SEPARATION_PAIRS_STRUCT
+struct separationPairs {
+  int count;
+  struct separationPair *pairs;
+};
+#endif
+
+/* Finds every separation pair in the network of numServers servers, leaving
+  out decommissioned servers and those in outageMask (which may be NULL),
+  using numThreads threads. */
+struct separationPairs *getSeparationPairs(struct graph *g, int numServers,
+  int outageMask[], int numThreads);
+
+/* Frees all memory used by pairs. */
+void freeSeparationPairs(struct separationPairs *pairs);
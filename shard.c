@@ -0,0 +1,514 @@
+/*
+shard.c
+
+Sharded breadth first search and label propagation
+
+Implementations for solving problems with the servers split into shards owned
+by worker processes which share memory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "graph.h"
+#include "shard.h"
+
+/* What the workers are asked to find. */
+enum shardJob {
+  SHARD_COMPONENTS=0,
+  SHARD_DIAMETER=1
+};
+
+/* Memory written by the workers, shared with the coordinator. */
+struct shardResults {
+  pthread_barrier_t barrier;
+  /* Servers each shard will look at in the next round. */
+  int active[MAXSHARDS];
+  /* Furthest distance reached in each shard and the smallest server at it. */
+  int furthest[MAXSHARDS];
+  int furthestServer[MAXSHARDS];
+  /* Longest shortest path over all searches, and its ends. */
+  int diameter;
+  int diameterStart;
+  int diameterEnd;
+};
+
+struct shards {
+  int numShards;
+  int numServers;
+  /* Servers [shard * chunk, (shard + 1) * chunk) belong to each shard. */
+  int chunk;
+  /* Read-only mapping holding the compacted rows and outage mask. */
+  void *rows;
+  size_t rowsBytes;
+  int *start;
+  int *target;
+  int *mask;
+  /* Read-write mapping: the distance or label of each server (written only by
+    its shard), the queues and the results. The queue from shard a to shard b
+    holds up to chunk entries starting at (a * numShards + b) * chunk. */
+  void *shared;
+  size_t sharedBytes;
+  int *value;
+  int *queueCount;
+  int *queueServer;
+  int *queueValue;
+  struct shardResults *results;
+};
+
+static size_t roundUp(size_t bytes){
+  return (bytes + 63) / 64 * 64;
+}
+
+static int owner(struct shards *s, int v){
+  return v / s->chunk;
+}
+
+static void *mapShared(size_t bytes){
+  void *mapped = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  assert(mapped != MAP_FAILED);
+  return mapped;
+}
+
+/* Lays out the shared memory for numShards workers over g. */
+static struct shards *newShards(struct graph *g, int numServers,
+  int outageMask[], int numShards){
+  struct adjacency *adj = getAdjacency(g);
+  struct shards *s = (struct shards *) malloc(sizeof(struct shards));
+  assert(s);
+  int v, k, slot = 0, total = 0;
+  pthread_barrierattr_t attr;
+  char *next;
+
+  s->numServers = numServers;
+  s->numShards = numShards;
+  s->chunk = (numServers + numShards - 1) / numShards;
+  for(v = 0; v < numServers; v++){
+    total += (adj->len)[v];
+  }
+
+  /* The rows are copied without their spare slots, then made read-only. */
+  s->rowsBytes = roundUp(sizeof(int) * (numServers + 1)) +
+    roundUp(sizeof(int) * (total + 1)) + roundUp(sizeof(int) * numServers);
+  s->rows = mapShared(s->rowsBytes);
+  next = (char *) s->rows;
+  s->start = (int *) next;
+  next += roundUp(sizeof(int) * (numServers + 1));
+  s->target = (int *) next;
+  next += roundUp(sizeof(int) * (total + 1));
+  s->mask = (int *) next;
+  for(v = 0; v < numServers; v++){
+    (s->start)[v] = slot;
+    for(k = (adj->start)[v]; k < (adj->start)[v] + (adj->len)[v]; k++){
+      (s->target)[slot++] = (adj->target)[k];
+    }
+    (s->mask)[v] = outageMask ? outageMask[v] : 0;
+  }
+  (s->start)[numServers] = slot;
+  assert(mprotect(s->rows, s->rowsBytes, PROT_READ) == 0);
+
+  s->sharedBytes = roundUp(sizeof(struct shardResults)) +
+    roundUp(sizeof(int) * numServers) +
+    roundUp(sizeof(int) * numShards * numShards) +
+    2 * roundUp(sizeof(int) * numShards * numShards * s->chunk);
+  s->shared = mapShared(s->sharedBytes);
+  next = (char *) s->shared;
+  s->results = (struct shardResults *) next;
+  next += roundUp(sizeof(struct shardResults));
+  s->value = (int *) next;
+  next += roundUp(sizeof(int) * numServers);
+  s->queueCount = (int *) next;
+  next += roundUp(sizeof(int) * numShards * numShards);
+  s->queueServer = (int *) next;
+  next += roundUp(sizeof(int) * numShards * numShards * s->chunk);
+  s->queueValue = (int *) next;
+
+  assert(pthread_barrierattr_init(&attr) == 0);
+  assert(pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0);
+  assert(pthread_barrier_init(&(s->results->barrier), &attr, numShards) == 0);
+  pthread_barrierattr_destroy(&attr);
+  return s;
+}
+
+static void freeShards(struct shards *s){
+  pthread_barrier_destroy(&(s->results->barrier));
+  munmap(s->rows, s->rowsBytes);
+  munmap(s->shared, s->sharedBytes);
+  free(s);
+}
+
+/* Scratch space private to one worker. */
+struct worker {
+  int shard;
+  int lo;
+  int hi;
+  /* Servers to look at in this round and the next, and for labels whether a
+    server is already waiting in list. */
+  int *list;
+  int listCount;
+  int *next;
+  int nextCount;
+  int *waiting;
+  /* Round in which each other shard's server was last queued, and where. */
+  int *sentRound;
+  int *sentAt;
+};
+
+static void newWorker(struct shards *s, struct worker *w, int shard){
+  int size = s->chunk > 0 ? s->chunk : 1;
+  w->shard = shard;
+  w->lo = shard * s->chunk;
+  w->hi = w->lo + s->chunk < s->numServers ? w->lo + s->chunk : s->numServers;
+  w->list = (int *) malloc(sizeof(int) * size);
+  assert(w->list);
+  w->next = (int *) malloc(sizeof(int) * size);
+  assert(w->next);
+  w->waiting = (int *) calloc(size, sizeof(int));
+  assert(w->waiting);
+  w->sentRound = (int *) malloc(sizeof(int) * (s->numServers + 1));
+  assert(w->sentRound);
+  w->sentAt = (int *) malloc(sizeof(int) * (s->numServers + 1));
+  assert(w->sentAt);
+  memset(w->sentRound, -1, sizeof(int) * (s->numServers + 1));
+  w->listCount = 0;
+  w->nextCount = 0;
+}
+
+static void freeWorker(struct worker *w){
+  free(w->list);
+  free(w->next);
+  free(w->waiting);
+  free(w->sentRound);
+  free(w->sentAt);
+}
+
+static void waitForShards(struct shards *s){
+  int result = pthread_barrier_wait(&(s->results->barrier));
+  assert(result == 0 || result == PTHREAD_BARRIER_SERIAL_THREAD);
+}
+
+/* Queues value for server v, owned by another shard, keeping only the
+  smallest value sent for v in this round. */
+static void sendUpdate(struct shards *s, struct worker *w, int v, int value,
+  int round){
+  int queue = w->shard * s->numShards + owner(s, v);
+  int *count = &(s->queueCount[queue]);
+  int base = queue * s->chunk;
+  if(w->sentRound[v] == round){
+    if(value < s->queueValue[base + w->sentAt[v]]){
+      s->queueValue[base + w->sentAt[v]] = value;
+    }
+    return;
+  }
+  w->sentRound[v] = round;
+  w->sentAt[v] = *count;
+  s->queueServer[base + *count] = v;
+  s->queueValue[base + *count] = value;
+  (*count)++;
+}
+
+/* Ends a round: waits for every shard to finish sending, hands each update
+  for this shard's servers to accept, then waits again and returns the number
+  of servers all the shards will look at in the next round. */
+static int exchange(struct shards *s, struct worker *w,
+  void (*accept)(struct shards *, struct worker *, int, int)){
+  int from, i, queue, base, total = 0;
+  waitForShards(s);
+  for(from = 0; from < s->numShards; from++){
+    queue = from * s->numShards + w->shard;
+    base = queue * s->chunk;
+    for(i = 0; i < s->queueCount[queue]; i++){
+      accept(s, w, s->queueServer[base + i], s->queueValue[base + i]);
+    }
+    /* The sender doesn't write to the queue again until after the barrier. */
+    s->queueCount[queue] = 0;
+  }
+  s->results->active[w->shard] = w->nextCount;
+  waitForShards(s);
+  for(i = 0; i < s->numShards; i++){
+    total += s->results->active[i];
+  }
+  return total;
+}
+
+/* A distance reached this shard's server v, it joins the next level if it
+  hadn't been reached before. */
+static void acceptDistance(struct shards *s, struct worker *w, int v,
+  int value){
+  if(s->value[v] == NOPATH){
+    s->value[v] = value;
+    w->next[w->nextCount++] = v;
+  }
+}
+
+/* A smaller label reached this shard's server v, it is looked at again. */
+static void acceptLabel(struct shards *s, struct worker *w, int v, int value){
+  if(value < s->value[v]){
+    s->value[v] = value;
+    if(! w->waiting[v - w->lo]){
+      w->waiting[v - w->lo] = 1;
+      w->next[w->nextCount++] = v;
+    }
+  }
+}
+
+/* Breadth first search from source, one level per round, adding the rounds
+  used to round. */
+static void shardedSearch(struct shards *s, struct worker *w, int source,
+  int *round){
+  int i, k, u, v, level = 0, *swap;
+  for(v = w->lo; v < w->hi; v++){
+    s->value[v] = NOPATH;
+  }
+  w->listCount = 0;
+  w->nextCount = 0;
+  if(owner(s, source) == w->shard){
+    s->value[source] = 0;
+    w->list[w->listCount++] = source;
+  }
+  while(1){
+    (*round)++;
+    for(i = 0; i < w->listCount; i++){
+      u = w->list[i];
+      for(k = s->start[u]; k < s->start[u + 1]; k++){
+        v = s->target[k];
+        if(v >= s->numServers || s->mask[v]) continue;
+        if(owner(s, v) == w->shard){
+          acceptDistance(s, w, v, level + 1);
+        } else {
+          sendUpdate(s, w, v, level + 1, *round);
+        }
+      }
+    }
+    if(exchange(s, w, acceptDistance) == 0){
+      break;
+    }
+    swap = w->list;
+    w->list = w->next;
+    w->next = swap;
+    w->listCount = w->nextCount;
+    w->nextCount = 0;
+    level++;
+  }
+}
+
+/* Task 4: a search from every surviving server, keeping the first source to
+  reach the largest distance and the smallest server it reaches there. */
+static void diameterWorker(struct shards *s, struct worker *w){
+  struct shardResults *r = s->results;
+  int source, v, i, round = 0, furthest, end;
+  if(w->shard == 0){
+    r->diameter = 0;
+    r->diameterStart = -1;
+    r->diameterEnd = -1;
+  }
+  for(source = 0; source < s->numServers; source++){
+    if(s->mask[source]) continue;
+    shardedSearch(s, w, source, &round);
+    furthest = 0;
+    end = -1;
+    for(v = w->lo; v < w->hi; v++){
+      if(v != source && s->value[v] != NOPATH && s->value[v] > furthest){
+        furthest = s->value[v];
+        end = v;
+      }
+    }
+    r->furthest[w->shard] = furthest;
+    r->furthestServer[w->shard] = end;
+    waitForShards(s);
+    if(w->shard == 0){
+      /* shards hold increasing servers, so the first at the largest distance
+        has the smallest server */
+      furthest = 0;
+      end = -1;
+      for(i = 0; i < s->numShards; i++){
+        if(r->furthest[i] > furthest){
+          furthest = r->furthest[i];
+          end = r->furthestServer[i];
+        }
+      }
+      if(furthest > r->diameter){
+        r->diameter = furthest;
+        r->diameterStart = source;
+        r->diameterEnd = end;
+      }
+    }
+  }
+}
+
+/* Spreads labels from the servers in the list through this shard until they
+  settle, sending them on to other shards' servers. */
+static void spreadLabels(struct shards *s, struct worker *w, int round){
+  int k, u, v, label;
+  while(w->listCount > 0){
+    u = w->list[--(w->listCount)];
+    w->waiting[u - w->lo] = 0;
+    label = s->value[u];
+    for(k = s->start[u]; k < s->start[u + 1]; k++){
+      v = s->target[k];
+      if(v >= s->numServers) continue;
+      if(owner(s, v) != w->shard){
+        sendUpdate(s, w, v, label, round);
+      } else if(label < s->value[v]){
+        s->value[v] = label;
+        if(! w->waiting[v - w->lo]){
+          w->waiting[v - w->lo] = 1;
+          w->list[w->listCount++] = v;
+        }
+      }
+    }
+  }
+}
+
+/* Tasks 2 and 3: every server starts with its own number as its label and the
+  smallest label in each subnetwork spreads through it. */
+static void componentsWorker(struct shards *s, struct worker *w){
+  int v, round = 1, *swap;
+  for(v = w->lo; v < w->hi; v++){
+    s->value[v] = v;
+  }
+  /* Spreading from the smallest server first labels every subnetwork within
+    the shard once. */
+  w->listCount = 0;
+  w->nextCount = 0;
+  for(v = w->lo; v < w->hi; v++){
+    if(s->value[v] == v){
+      w->waiting[v - w->lo] = 1;
+      w->list[w->listCount++] = v;
+      spreadLabels(s, w, round);
+    }
+  }
+  while(exchange(s, w, acceptLabel) > 0){
+    round++;
+    swap = w->list;
+    w->list = w->next;
+    w->next = swap;
+    w->listCount = w->nextCount;
+    w->nextCount = 0;
+    spreadLabels(s, w, round);
+  }
+}
+
+/* Forks one worker per shard to do the job and waits for them all. */
+static void runShards(struct shards *s, enum shardJob job){
+  int shard, status;
+  pid_t pids[MAXSHARDS];
+  struct worker w;
+  memset(s->queueCount, 0, sizeof(int) * s->numShards * s->numShards);
+  fflush(stdout);
+  for(shard = 0; shard < s->numShards; shard++){
+    pids[shard] = fork();
+    assert(pids[shard] != -1);
+    if(pids[shard] == 0){
+      newWorker(s, &w, shard);
+      if(job == SHARD_DIAMETER){
+        diameterWorker(s, &w);
+      } else {
+        componentsWorker(s, &w);
+      }
+      freeWorker(&w);
+      _exit(EXIT_SUCCESS);
+    }
+  }
+  for(shard = 0; shard < s->numShards; shard++){
+    assert(waitpid(pids[shard], &status, 0) == pids[shard]);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+  }
+}
+
+struct solution *shardedSolve(struct graph *g, enum problemPart part,
+  int numServers, int numOutages, int *outages, int numShards){
+  struct solution *solution = (struct solution *)
+    malloc(sizeof(struct solution));
+  assert(solution);
+  int i, largest = -1, count = 0;
+  initaliseSolution(solution);
+  assert(part == TASK_2 || part == TASK_3 || part == TASK_4);
+  if(numServers <= 0){
+    return solution;
+  }
+  if(numShards > numServers){
+    numShards = numServers;
+  }
+  if(numShards > MAXSHARDS){
+    numShards = MAXSHARDS;
+  }
+  if(numShards < 1){
+    numShards = 1;
+  }
+
+  if(part == TASK_4){
+    struct workspace *ws = newWorkspace(numServers);
+    int *outageMask = (int *) malloc(sizeof(int) * numServers);
+    assert(outageMask);
+    getOutageMask(outageMask, numServers, outages, numOutages);
+    maskRemoved(g, outageMask, numServers);
+    struct shards *s = newShards(g, numServers, outageMask, numShards);
+    runShards(s, SHARD_DIAMETER);
+    solution->postOutageDiameter = s->results->diameter;
+    if(s->results->diameter > 0){
+      /* the path is found as Task 4 finds it, from the chosen start */
+      int *dist = (int *) malloc(sizeof(int) * numServers);
+      assert(dist);
+      int *prev = (int *) malloc(sizeof(int) * numServers);
+      assert(prev);
+      dijkstras(ws, g, s->results->diameterStart, dist, prev, numServers,
+        outageMask);
+      solution->postOutageDiameterCount = s->results->diameter + 1;
+      solution->postOutageDiameterSIDs = (int *) malloc(sizeof(int) *
+        solution->postOutageDiameterCount);
+      assert(solution->postOutageDiameterSIDs);
+      populateServers(solution->postOutageDiameterSIDs, prev,
+        s->results->diameterStart, s->results->diameterEnd,
+        s->results->diameter);
+      free(dist);
+      free(prev);
+    }
+    freeShards(s);
+    free(outageMask);
+    freeWorkspace(ws);
+    return solution;
+  }
+
+  /* every server ends up labelled with the smallest server in its
+    subnetwork */
+  struct shards *s = newShards(g, numServers, NULL, numShards);
+  runShards(s, SHARD_COMPONENTS);
+  int *size = (int *) calloc(numServers, sizeof(int));
+  assert(size);
+  for(i = 0; i < numServers; i++){
+    /* decommissioned servers belong to no subnetwork */
+    if(isRemoved(g, i)) continue;
+    if(s->value[i] == i){
+      solution->connectedSubnets++;
+    }
+    size[s->value[i]]++;
+  }
+  if(part == TASK_3){
+    /* the largest subnetwork, ties going to the one with the smaller server */
+    for(i = 0; i < numServers; i++){
+      if(size[i] > 0 && (largest == -1 || size[i] > size[largest])){
+        largest = i;
+      }
+    }
+    if(largest != -1){
+      solution->largestSubnet = size[largest];
+      solution->largestSubnetSIDs = (int *) malloc(sizeof(int) *
+        size[largest]);
+      assert(solution->largestSubnetSIDs);
+      for(i = 0; i < numServers; i++){
+        if(s->value[i] == largest && ! isRemoved(g, i)){
+          (solution->largestSubnetSIDs)[count++] = i;
+        }
+      }
+    }
+  }
+  free(size);
+  freeShards(s);
+  return solution;
+}
@@ -0,0 +1,25 @@
+/*
+shard.h
+
+Visible functions for solving problems with the servers split into shards,
+each owned by its own worker process.
+
+The coordinator copies the adjacency rows into a read-only shared mapping,
+  then forks one worker per shard. Each worker keeps the distances or labels
+  of its own servers and passes updates for servers owned by other shards
+  through queues in shared memory, with every worker waiting at a
+  process-shared barrier between rounds.
+*/
+/* Because we use struct graph, struct solution and enum problemPart in this
+  file, we should include graph.h here. */
+#include "graph.h"
+
+/* Most worker processes used. */
+#define MAXSHARDS 64
+
+/* Finds the solution to Task 2, 3 or 4 with numShards worker processes,
+  giving the same answer as graphSolve. Task 4 runs a breadth first search
+  from every surviving server across the shards, then finds the path itself
+  as the single process version would. */
+struct solution *shardedSolve(struct graph *g, enum problemPart part,
+  int numServers, int numOutages, int *outages, int numShards);
@@ -0,0 +1,392 @@
+/*
+snapshot.c
+
+Snapshot file implementation.
+
+A snapshot file is a header, a table of sections and then the integers of each
+section. The header records the version of the layout, the hashes of the
+network and outage it was made for and a checksum of everything after it, so
+a file which doesn't match in every respect is simply ignored.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "graph.h"
+#include "snapshot.h"
+
+#define SNAPSHOTMAGIC "GRPHSNAP"
+#define SNAPSHOTVERSION 1
+/* Written as a number so files from machines with another byte order are
+  recognised. */
+#define BYTEORDER 0x01020304u
+#define FNVPRIME 1099511628211ULL
+
+/* Kinds of sections, each held at most once. */
+enum sectionKind {
+  COMPONENT_LABELS=0,
+  CRITICAL_SERVERS=1,
+  ECCENTRICITIES=2,
+  NUMSECTIONKINDS=3
+};
+
+struct snapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t networkHash;
+  uint64_t outageHash;
+  int32_t numServers;
+  uint32_t numSections;
+  uint64_t checksum;
+};
+
+struct snapshotSection {
+  uint32_t kind;
+  uint32_t count;
+  uint64_t offset;
+};
+
+struct snapshot {
+  char *path;
+  uint64_t networkHash;
+  uint64_t outageHash;
+  int numServers;
+  int wasValid;
+  /* The mapped file, if there is a valid one. */
+  void *map;
+  size_t mapSize;
+  /* Each section either points into the map or is owned by the snapshot. */
+  const int32_t *sections[NUMSECTIONKINDS];
+  uint32_t counts[NUMSECTIONKINDS];
+  int owned[NUMSECTIONKINDS];
+};
+
+unsigned long long hashInts(unsigned long long hash, const int *values,
+  int count){
+  int i;
+  size_t j;
+  /* FNV-1a over the bytes of each value. */
+  for(i = 0; i < count; i++){
+    uint32_t value = (uint32_t) values[i];
+    for(j = 0; j < sizeof(value); j++){
+      hash ^= (value >> (8 * j)) & 0xff;
+      hash *= FNVPRIME;
+    }
+  }
+  return hash;
+}
+
+static uint64_t checksumBytes(const unsigned char *bytes, size_t size){
+  uint64_t hash = HASHSEED;
+  size_t i;
+  for(i = 0; i < size; i++){
+    hash ^= bytes[i];
+    hash *= FNVPRIME;
+  }
+  return hash;
+}
+
+/* Maps the snapshot file and points the sections into it if the file is
+  valid for this network and outage, otherwise leaves the snapshot empty. */
+static void mapSnapshot(struct snapshot *snapshot){
+  struct stat info;
+  const struct snapshotHeader *header;
+  const struct snapshotSection *table;
+  uint32_t i;
+  int fd = open(snapshot->path, O_RDONLY);
+  if(fd < 0){
+    return;
+  }
+  if(fstat(fd, &info) != 0 ||
+    (size_t) info.st_size < sizeof(struct snapshotHeader)){
+    close(fd);
+    return;
+  }
+  snapshot->mapSize = (size_t) info.st_size;
+  snapshot->map = mmap(NULL, snapshot->mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(snapshot->map == MAP_FAILED){
+    snapshot->map = NULL;
+    return;
+  }
+
+  header = (const struct snapshotHeader *) snapshot->map;
+  table = (const struct snapshotSection *) (header + 1);
+  if(memcmp(header->magic, SNAPSHOTMAGIC, sizeof(header->magic)) != 0 ||
+    header->version != SNAPSHOTVERSION || header->byteOrder != BYTEORDER ||
+    header->networkHash != snapshot->networkHash ||
+    header->outageHash != snapshot->outageHash ||
+    header->numServers != snapshot->numServers ||
+    header->numSections > NUMSECTIONKINDS ||
+    sizeof(struct snapshotHeader) + header->numSections *
+      sizeof(struct snapshotSection) > snapshot->mapSize ||
+    header->checksum != checksumBytes((const unsigned char *) table,
+      snapshot->mapSize - sizeof(struct snapshotHeader))){
+    munmap(snapshot->map, snapshot->mapSize);
+    snapshot->map = NULL;
+    return;
+  }
+  for(i = 0; i < header->numSections; i++){
+    if(table[i].kind >= NUMSECTIONKINDS || table[i].offset % sizeof(int32_t) ||
+      table[i].offset + (uint64_t) table[i].count * sizeof(int32_t) >
+        snapshot->mapSize){
+      continue;
+    }
+    (snapshot->sections)[table[i].kind] = (const int32_t *)
+      ((const char *) snapshot->map + table[i].offset);
+    (snapshot->counts)[table[i].kind] = table[i].count;
+  }
+  snapshot->wasValid = 1;
+}
+
+struct snapshot *openSnapshot(const char *path, unsigned long long networkHash,
+  unsigned long long outageHash, int numServers){
+  int i;
+  struct snapshot *snapshot = (struct snapshot *)
+    malloc(sizeof(struct snapshot));
+  assert(snapshot);
+  snapshot->path = strdup(path);
+  assert(snapshot->path);
+  snapshot->networkHash = networkHash;
+  snapshot->outageHash = outageHash;
+  snapshot->numServers = numServers;
+  snapshot->wasValid = 0;
+  snapshot->map = NULL;
+  snapshot->mapSize = 0;
+  for(i = 0; i < NUMSECTIONKINDS; i++){
+    (snapshot->sections)[i] = NULL;
+    (snapshot->counts)[i] = 0;
+    (snapshot->owned)[i] = 0;
+  }
+  mapSnapshot(snapshot);
+  return snapshot;
+}
+
+int snapshotWasValid(struct snapshot *snapshot){
+  return snapshot->wasValid;
+}
+
+/* Writes every section to a new file which then replaces the old one, so a
+  crash part way through never leaves a damaged snapshot behind. */
+static void saveSnapshot(struct snapshot *snapshot){
+  struct snapshotHeader header;
+  struct snapshotSection table[NUMSECTIONKINDS];
+  uint32_t numSections = 0;
+  uint64_t offset;
+  size_t size;
+  int i;
+
+  memcpy(header.magic, SNAPSHOTMAGIC, sizeof(header.magic));
+  header.version = SNAPSHOTVERSION;
+  header.byteOrder = BYTEORDER;
+  header.networkHash = snapshot->networkHash;
+  header.outageHash = snapshot->outageHash;
+  header.numServers = snapshot->numServers;
+  for(i = 0; i < NUMSECTIONKINDS; i++){
+    if((snapshot->sections)[i]){
+      numSections++;
+    }
+  }
+  header.numSections = numSections;
+
+  offset = sizeof(header) + numSections * sizeof(struct snapshotSection);
+  numSections = 0;
+  for(i = 0; i < NUMSECTIONKINDS; i++){
+    if(! (snapshot->sections)[i]){
+      continue;
+    }
+    table[numSections].kind = i;
+    table[numSections].count = (snapshot->counts)[i];
+    table[numSections].offset = offset;
+    offset += (snapshot->counts)[i] * sizeof(int32_t);
+    numSections++;
+  }
+
+  /* Lay the file out in memory first so the checksum can go in the header. */
+  size = (size_t) offset;
+  unsigned char *contents = (unsigned char *) malloc(size);
+  assert(contents);
+  memcpy(contents + sizeof(header), table,
+    numSections * sizeof(struct snapshotSection));
+  for(i = 0; i < (int) numSections; i++){
+    memcpy(contents + table[i].offset, (snapshot->sections)[table[i].kind],
+      table[i].count * sizeof(int32_t));
+  }
+  header.checksum = checksumBytes(contents + sizeof(header),
+    size - sizeof(header));
+  memcpy(contents, &header, sizeof(header));
+
+  size_t pathLength = strlen(snapshot->path);
+  char *tempPath = (char *) malloc(pathLength + 5);
+  assert(tempPath);
+  memcpy(tempPath, snapshot->path, pathLength);
+  memcpy(tempPath + pathLength, ".tmp", 5);
+  FILE *file = fopen(tempPath, "wb");
+  if(file){
+    int written = fwrite(contents, 1, size, file) == size;
+    if(fclose(file) == 0 && written){
+      rename(tempPath, snapshot->path);
+    } else {
+      remove(tempPath);
+    }
+  } else {
+    fprintf(stderr, "Could not write snapshot %s\n", snapshot->path);
+  }
+  free(tempPath);
+  free(contents);
+}
+
+/* Replaces a section with a copy of the given values and saves the file. */
+static void storeSection(struct snapshot *snapshot, int kind,
+  const int *values, int count){
+  int i;
+  int32_t *copy = (int32_t *) malloc(sizeof(int32_t) * (count > 0 ? count : 1));
+  assert(copy);
+  for(i = 0; i < count; i++){
+    copy[i] = values[i];
+  }
+  if((snapshot->owned)[kind]){
+    free((void *) (snapshot->sections)[kind]);
+  }
+  (snapshot->sections)[kind] = copy;
+  (snapshot->counts)[kind] = count;
+  (snapshot->owned)[kind] = 1;
+  saveSnapshot(snapshot);
+}
+
+/* Copies a section out of the snapshot into a new array of ints. */
+static int *copySection(struct snapshot *snapshot, int kind){
+  uint32_t i, count = (snapshot->counts)[kind];
+  int *values = (int *) malloc(sizeof(int) * (count > 0 ? count : 1));
+  assert(values);
+  for(i = 0; i < count; i++){
+    values[i] = (snapshot->sections)[kind][i];
+  }
+  return values;
+}
+
+/* Returns 1 if every value in the section is a server, 0 otherwise. */
+static int sectionInRange(struct snapshot *snapshot, int kind,
+  int numServers){
+  uint32_t i;
+  for(i = 0; i < (snapshot->counts)[kind]; i++){
+    if((snapshot->sections)[kind][i] < 0 ||
+      (snapshot->sections)[kind][i] >= numServers){
+      return 0;
+    }
+  }
+  return 1;
+}
+
+struct solution *snapshotSolve(struct snapshot *snapshot, struct workspace *ws,
+  struct graph *g, enum problemPart part, int numServers, int numOutages,
+  int *outages){
+  struct solution *solution;
+  int i, j, kind;
+
+  if(part == TASK_2 || part == TASK_3){
+    kind = COMPONENT_LABELS;
+  } else if(part == TASK_7){
+    kind = CRITICAL_SERVERS;
+  } else if(part == TASK_ECCENTRICITY){
+    kind = ECCENTRICITIES;
+  } else {
+    return NULL;
+  }
+  if(! (snapshot->sections)[kind]){
+    return NULL;
+  }
+  if(numServers < 0 || (kind != CRITICAL_SERVERS &&
+    (snapshot->counts)[kind] != (uint32_t) numServers)){
+    return NULL;
+  }
+  /* Labels and critical servers index per server arrays, so a snapshot
+    holding any out of range is not used. */
+  if(kind != ECCENTRICITIES && ! sectionInRange(snapshot, kind, numServers)){
+    return NULL;
+  }
+  solution = (struct solution *) malloc(sizeof(struct solution));
+  assert(solution);
+  initaliseSolution(solution);
+
+  if(kind == COMPONENT_LABELS){
+    /* Labels are in order of each subnetwork's smallest server, so the first
+      of the largest labels wins ties. */
+    const int32_t *label = (snapshot->sections)[kind];
+    int largest = 0;
+    int *size = (int *) calloc(numServers > 0 ? numServers : 1, sizeof(int));
+    assert(size);
+    for(i = 0; i < numServers; i++){
+      size[label[i]]++;
+      if(label[i] + 1 > solution->connectedSubnets){
+        solution->connectedSubnets = label[i] + 1;
+      }
+    }
+    if(part == TASK_3 && numServers > 0){
+      for(i = 1; i < solution->connectedSubnets; i++){
+        if(size[i] > size[largest]){
+          largest = i;
+        }
+      }
+      solution->largestSubnet = size[largest];
+      solution->largestSubnetSIDs = (int *) malloc(sizeof(int) *
+        size[largest]);
+      assert(solution->largestSubnetSIDs);
+      for(i = 0, j = 0; i < numServers; i++){
+        if(label[i] == largest){
+          (solution->largestSubnetSIDs)[j++] = i;
+        }
+      }
+    }
+    free(size);
+  } else if(kind == CRITICAL_SERVERS){
+    solution->criticalServerCount = (snapshot->counts)[kind];
+    solution->criticalServerSIDs = copySection(snapshot, kind);
+  } else {
+    int *outageMask = workspaceOutageMask(ws);
+    getOutageMask(outageMask, numServers, outages, numOutages);
+    maskRemoved(g, outageMask, numServers);
+    solution->eccentricityCount = numServers;
+    solution->eccentricities = copySection(snapshot, kind);
+    getCentre(ws, g, numServers, outageMask, solution);
+  }
+  return solution;
+}
+
+void snapshotRecord(struct snapshot *snapshot, struct workspace *ws,
+  struct graph *g, enum problemPart part, struct solution *solution,
+  int numServers){
+  if(part == TASK_2 || part == TASK_3){
+    struct components *components = getComponents(ws, g, numServers, NULL);
+    storeSection(snapshot, COMPONENT_LABELS, components->label, numServers);
+  } else if(part == TASK_7){
+    storeSection(snapshot, CRITICAL_SERVERS, solution->criticalServerSIDs,
+      solution->criticalServerCount);
+  } else if(part == TASK_ECCENTRICITY){
+    storeSection(snapshot, ECCENTRICITIES, solution->eccentricities,
+      solution->eccentricityCount);
+  }
+}
+
+void freeSnapshot(struct snapshot *snapshot){
+  int i;
+  if(! snapshot){
+    return;
+  }
+  for(i = 0; i < NUMSECTIONKINDS; i++){
+    if((snapshot->owned)[i]){
+      free((void *) (snapshot->sections)[i]);
+    }
+  }
+  if(snapshot->map){
+    munmap(snapshot->map, snapshot->mapSize);
+  }
+  free(snapshot->path);
+  free(snapshot);
+}
@@ -0,0 +1,46 @@
+/*
+snapshot.h
+
+Visible structs and functions for snapshots, files holding the structures
+derived from a network (subnetwork labels, critical servers and
+eccentricities) so that later runs on the same network and outage can map them
+into memory instead of computing them again.
+*/
+/* Because we use struct solution, struct workspace and enum problemPart in
+  this file, we should include graph.h here. */
+#include "graph.h"
+
+/* Starting value for hashInts. */
+#define HASHSEED 14695981039346656037ULL
+
+/* A snapshot file and the structures held in it. */
+struct snapshot;
+
+/* Adds count integers to the running hash, returning the new hash. */
+unsigned long long hashInts(unsigned long long hash, const int *values,
+  int count);
+
+/* Opens the snapshot at path for a network and outage with the given hashes.
+  If the file is missing, from another version, damaged or made for a
+  different network or outage it is ignored, and replaced the next time a
+  structure is saved. */
+struct snapshot *openSnapshot(const char *path, unsigned long long networkHash,
+  unsigned long long outageHash, int numServers);
+
+/* Returns 1 if a valid snapshot was found when it was opened, 0 otherwise. */
+int snapshotWasValid(struct snapshot *snapshot);
+
+/* Finds the solution to the given part from the snapshot alone (with a linear
+  pass for the radius and centre). Returns NULL if the snapshot doesn't hold
+  what the part needs. */
+struct solution *snapshotSolve(struct snapshot *snapshot, struct workspace *ws,
+  struct graph *g, enum problemPart part, int numServers, int numOutages,
+  int *outages);
+
+/* Saves the structures behind a freshly found solution to the snapshot file. */
+void snapshotRecord(struct snapshot *snapshot, struct workspace *ws,
+  struct graph *g, enum problemPart part, struct solution *solution,
+  int numServers);
+
+/* Unmaps the snapshot file and frees all memory used by snapshot. */
+void freeSnapshot(struct snapshot *snapshot);
@@ -0,0 +1,51 @@
+/*
+task4a.c
+
+Driver function for Task 4 within a time limit.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt milliseconds "
+      "< tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  /* Find the diameter within the number of milliseconds in argv[2]. */
+  struct solution *solution = findDiameterWithin(problem, atoi(argv[2]));
+
+  /* Report solution */
+  printf("After the outage, the largest diameter found in any of the "
+         "subnetworks is: %d\n", solution->postOutageDiameter);
+  printf("The path is: ");
+  int i;
+  for(i = 0; i < solution->postOutageDiameterCount; i++){
+    printf("%d", (solution->postOutageDiameterSIDs)[i]);
+    if((i + 1) < solution->postOutageDiameterCount){
+      printf(" ");
+    }
+  }
+  printf("\n");
+  printf("The largest diameter is at most: %d\n",
+    solution->postOutageDiameterBound);
+  if(solution->postOutageDiameterExact){
+    printf("The diameter is exact\n");
+  } else {
+    printf("The time ran out before the diameter was exact\n");
+  }
+
+  freeProblem(problem);
+  freeSolution(solution);
+
+  return 0;
+}
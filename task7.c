@@ -13,7 +13,7 @@ Skeleton written by Grady Fitzpatrick for COMP20007 Assignment 2 2021
 
 int main(int argc, char **argv){
   if(argc < 2){
-    fprintf(stderr, "Run in the form %s tests/network-t7-1 < outage-t7-1.txt\n",
+    fprintf(stderr, "Run in the form %s tests/network-t7-1 [snapshot] < outage-t7-1.txt\n",
       argv[0]);
     exit(EXIT_FAILURE);
   }
@@ -22,6 +22,10 @@ int main(int argc, char **argv){
   assert(networkFile);
   struct graphProblem *problem = readProblem(stdin, networkFile);
   assert(fclose(networkFile) == 0);
+  /* An optional argv[2] names a snapshot file to reuse results from. */
+  if(argc > 2){
+    useSnapshot(problem, argv[2]);
+  }
 
   /* Find the solution to the problem. */
   struct solution *solution = findSolution(problem, TASK_7);
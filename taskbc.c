@@ -0,0 +1,65 @@
+/*
+taskbc.c
+
+Driver function for ranking servers by betweenness centrality after the
+outage: how many shortest paths between other servers pass through them.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include "utils.h"
+#include "graph.h"
+#include "centrality.h"
+
+/* Number of servers listed if none is given. */
+#define DEFAULTTOP 5
+/* Seed for picking sources when sampling. */
+#define SAMPLESEED 20007
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [k] [samples] "
+      "[threads] < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int k = DEFAULTTOP, samples = 0;
+  int numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if(argc > 2){
+    k = atoi(argv[2]);
+  }
+  if(argc > 3){
+    samples = atoi(argv[3]);
+  }
+  if(argc > 4){
+    numThreads = atoi(argv[4]);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  struct centrality *c = findBetweenness(problem, samples, numThreads,
+    SAMPLESEED);
+
+  /* Report solution */
+  int *top = (int *) malloc(sizeof(int) * (k > 0 ? k : 1));
+  assert(top);
+  int i, count = topCentral(c, k, top);
+  printf("After the outage, the servers on the most shortest paths are:\n");
+  for(i = 0; i < count; i++){
+    printf("Server %d: %.2f\n", top[i], (c->score)[top[i]]);
+  }
+  if(c->sources < c->survivors){
+    printf("Estimated from %d of %d servers, each within %.2f with %.0f%% "
+           "confidence\n", c->sources, c->survivors, c->errorBound,
+           100 * CENTRALITYCONFIDENCE);
+  }
+
+  free(top);
+  freeProblem(problem);
+  freeCentrality(c);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*
+taskbench.c
+
+Benchmark of the Task 3, Task 4 and Task 7 traversals with and without huge
+page backed memory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "utils.h"
+#include "graph.h"
+#include "arena.h"
+
+#define DEFAULTREPEATS 5
+
+/* Names for how a block was found, in the order of enum backing. */
+static const char *backingNames[] = {"malloc", "hugetlb", "transparent"};
+
+/* Opens a counter of data TLB read misses in this process, returning -1 if
+  the system won't allow it. */
+static int openTLBCounter(void){
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB |
+    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Loads the problem with huge pages on or off, then times repeats of Tasks 3,
+  7 and 4 (a Dijkstra search from every server), storing the milliseconds and
+  data TLB misses taken (-1 if they couldn't be counted). */
+static void runBench(const char *networkPath, FILE *outageFile, int huge,
+  int repeats, double *milliseconds, long long *misses){
+  int i, counter;
+  long long count;
+  double start;
+  struct solution *solution;
+
+  useHugePages(huge);
+  FILE *networkFile = fopen(networkPath, "r");
+  assert(networkFile);
+  rewind(outageFile);
+  struct graphProblem *problem = readProblem(outageFile, networkFile);
+  assert(fclose(networkFile) == 0);
+  /* Build the adjacency rows and workspace before timing. */
+  freeSolution(findSolution(problem, TASK_2));
+
+  counter = openTLBCounter();
+  if(counter != -1){
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  start = nowMilliseconds();
+  for(i = 0; i < repeats; i++){
+    solution = findSolution(problem, TASK_3);
+    freeSolution(solution);
+    solution = findSolution(problem, TASK_7);
+    freeSolution(solution);
+    solution = findSolution(problem, TASK_4);
+    freeSolution(solution);
+  }
+  *milliseconds = nowMilliseconds() - start;
+  *misses = -1;
+  if(counter != -1){
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if(read(counter, &count, sizeof(count)) == sizeof(count)){
+      *misses = count;
+    }
+    close(counter);
+  }
+  freeProblem(problem);
+}
+
+static void printMisses(long long misses){
+  if(misses < 0){
+    printf("n/a\n");
+  } else {
+    printf("%lld\n", misses);
+  }
+}
+
+int main(int argc, char **argv){
+  int c, repeats = DEFAULTREPEATS;
+  double defaultTime, hugeTime;
+  long long defaultMisses, hugeMisses;
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [repeats] "
+      "< tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  if(argc > 2){
+    repeats = atoi(argv[2]);
+  }
+  /* The outage is read once for each run, so keep a copy of stdin. */
+  FILE *outageFile = tmpfile();
+  assert(outageFile);
+  while((c = getchar()) != EOF){
+    fputc(c, outageFile);
+  }
+
+  /* Find what large blocks get when huge pages are on. */
+  useHugePages(1);
+  void *probe = hugeAlloc((size_t) 4 * 1024 * 1024);
+  printf("Huge page backing available: %s\n",
+    backingNames[hugeBacking(probe)]);
+  hugeFree(probe);
+
+  runBench(argv[1], outageFile, 0, repeats, &defaultTime, &defaultMisses);
+  runBench(argv[1], outageFile, 1, repeats, &hugeTime, &hugeMisses);
+  assert(fclose(outageFile) == 0);
+
+  printf("Default allocation: %.1f ms, data TLB misses: ", defaultTime);
+  printMisses(defaultMisses);
+  printf("Huge page allocation: %.1f ms, data TLB misses: ", hugeTime);
+  printMisses(hugeMisses);
+  printf("Speedup with huge pages: %.2fx\n", defaultTime / hugeTime);
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+/*
+taskcomp.c
+
+Driver function for the subnetwork inventory report: the largest subnetworks
+with their servers, and how many subnetworks there are of each size.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+
+/* Number of subnetworks listed if none is given. */
+#define DEFAULTTOP 3
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [k] < tests/outage-1.txt\n",
+      argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int k = DEFAULTTOP;
+  if(argc > 2){
+    k = atoi(argv[2]);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  /* Label every server's subnetwork before the outage. */
+  struct components *components = findComponents(problem, 0);
+
+  /* Report solution */
+  printf("Before the outage, the number of connected subnetworks is: %d\n",
+    components->numComponents);
+
+  int *top = (int *) malloc(sizeof(int) * (k > 0 ? k : 1));
+  assert(top);
+  int i, j, count = topComponents(components, k, top);
+  for(i = 0; i < count; i++){
+    printf("Subnetwork %d has %d servers: ", i + 1,
+      (components->size)[top[i]]);
+    for(j = (components->memberStart)[top[i]];
+      j < (components->memberStart)[top[i] + 1]; j++){
+      printf("%d", (components->members)[j]);
+      if((j + 1) < (components->memberStart)[top[i] + 1]){
+        printf(" ");
+      }
+    }
+    printf("\n");
+  }
+
+  free(top);
+
+  int *histogram = (int *) malloc(sizeof(int) *
+    (components->numServers + 1));
+  assert(histogram);
+  int largest = getSizeHistogram(components, histogram);
+  printf("The number of subnetworks of each size is:");
+  for(i = 1; i <= largest; i++){
+    if(histogram[i] > 0){
+      printf(" %d:%d", i, histogram[i]);
+    }
+  }
+  printf("\n");
+
+  free(histogram);
+  freeProblem(problem);
+
+  return 0;
+}
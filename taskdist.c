@@ -0,0 +1,101 @@
+/*
+taskdist.c
+
+Driver function for point to point distances after the outage: the number of
+hops between pairs of servers and a shortest path between them, answered from
+a distance index built once for the network.
+
+Each line of the queries file is two servers, optionally followed by a
+different outage in the form of an outage file, e.g. "1 13 2 5 6" for servers
+5 and 6 failing instead.
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+#include "distindex.h"
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt "
+      "tests/queries-1.txt < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+  FILE *queryFile = fopen(argv[2], "r");
+  assert(queryFile);
+
+  struct distanceIndex *index = findDistanceIndex(problem);
+  int numServers = distanceIndexServers(index);
+  printf("The distance index has %lld labels, %.2f per server\n",
+    distanceIndexLabels(index), numServers > 0 ?
+    (double) distanceIndexLabels(index) / numServers : 0);
+
+  int *path = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(path);
+  int *outageSIDs = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(outageSIDs);
+  char *line = NULL;
+  size_t size = 0;
+  int a, b, d, i, used, offset, outageCount, queries = 0;
+  double spent = 0, begin;
+  while(getline(&line, &size, queryFile) != -1){
+    if(sscanf(line, "%d %d%n", &a, &b, &offset) != 2) continue;
+    /* A count after the two servers starts a different outage. */
+    outageCount = -1;
+    if(sscanf(line + offset, "%d%n", &outageCount, &used) == 1){
+      offset += used;
+      assert(outageCount >= 0 && outageCount <= numServers);
+      for(i = 0; i < outageCount; i++){
+        assert(sscanf(line + offset, "%d%n", &(outageSIDs[i]), &used) == 1);
+        offset += used;
+      }
+    }
+
+    begin = nowMilliseconds();
+    d = queryDistance(index, outageCount, outageCount < 0 ? NULL : outageSIDs,
+      a, b, path);
+    spent += nowMilliseconds() - begin;
+    queries++;
+
+    /* Report solution */
+    printf("From server %d to server %d", a, b);
+    if(outageCount == 0){
+      printf(" with no outage");
+    } else if(outageCount > 0){
+      printf(" with outage");
+      for(i = 0; i < outageCount; i++){
+        printf(" %d", outageSIDs[i]);
+      }
+    }
+    if(d == NOPATH){
+      printf(": no path\n");
+      continue;
+    }
+    printf(": %d hop%s, the path is:", d, d == 1 ? "" : "s");
+    for(i = 0; i <= d; i++){
+      printf(" %d", path[i]);
+    }
+    printf("\n");
+  }
+  /* Timings vary from run to run, so are kept out of the answers. */
+  if(queries > 0){
+    fprintf(stderr, "Answered %d queries in %.2f microseconds each\n",
+      queries, spent * 1000.0 / queries);
+  }
+
+  free(line);
+  free(path);
+  free(outageSIDs);
+  assert(fclose(queryFile) == 0);
+  freeDistanceIndex(index);
+  freeProblem(problem);
+
+  return 0;
+}
@@ -0,0 +1,62 @@
+/*
+taskecc.c
+
+Driver function for the eccentricity, radius and centre report.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [snapshot] < tests/outage-1.txt\n",
+      argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+  /* An optional argv[2] names a snapshot file to reuse results from. */
+  if(argc > 2){
+    useSnapshot(problem, argv[2]);
+  }
+
+  /* Find the solution to the problem. */
+  struct solution *solution = findSolution(problem, TASK_ECCENTRICITY);
+
+  /* Report solution */
+  printf("After the outage, the eccentricities of the servers are: ");
+  int i, first = 1;
+  for(i = 0; i < solution->eccentricityCount; i++){
+    /* Servers affected by the outage have no eccentricity. */
+    if((solution->eccentricities)[i] < 0){
+      continue;
+    }
+    if(! first){
+      printf(" ");
+    }
+    printf("%d:%d", i, (solution->eccentricities)[i]);
+    first = 0;
+  }
+  printf("\n");
+
+  printf("The radius of the largest subnetwork is: %d\n",
+    solution->postOutageRadius);
+  printf("The centre servers are: ");
+  for(i = 0; i < solution->centreCount; i++){
+    printf("%d", (solution->centreSIDs)[i]);
+    if((i + 1) < solution->centreCount){
+      printf(" ");
+    }
+  }
+  printf("\n");
+
+  freeProblem(problem);
+  freeSolution(solution);
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+/*
+taskext.c
+
+Driver function for Tasks 2, 3 and 7 in semi-external mode, for network files
+too large to hold in memory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "graph.h"
+#include "extgraph.h"
+
+/* Memory budget for buffering connections if none is given, in kilobytes. */
+#define DEFAULTBUDGETKB 65536
+
+static void printServers(int count, int *servers){
+  int i;
+  for(i = 0; i < count; i++){
+    printf("%d", servers[i]);
+    if((i + 1) < count){
+      printf(" ");
+    }
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s 2|3|7 tests/network-1.txt "
+      "[memory budget in KB]\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int task = atoi(argv[1]);
+  size_t budget = (size_t) DEFAULTBUDGETKB * 1024;
+  if(argc > 3){
+    budget = (size_t) atol(argv[3]) * 1024;
+  }
+  enum problemPart part;
+  if(task == 2){
+    part = TASK_2;
+  } else if(task == 3){
+    part = TASK_3;
+  } else if(task == 7){
+    part = TASK_7;
+  } else {
+    fprintf(stderr, "Only tasks 2, 3 and 7 can be run in semi-external mode\n");
+    exit(EXIT_FAILURE);
+  }
+
+  struct extGraph *eg = openExtGraph(argv[2], budget);
+  struct solution *solution = extGraphSolve(eg, part);
+
+  /* Report solution in the same form as the in-memory drivers. */
+  if(part == TASK_2){
+    printf("Before the outage, the number of connected subnetworks is: %d\n",
+      solution->connectedSubnets);
+  } else if(part == TASK_3){
+    printf("Before the outage, the number of servers in the largest "
+           "subnetwork is: %d\n", solution->largestSubnet);
+    printf("The servers in the largest subnetwork are: ");
+    printServers(solution->largestSubnet, solution->largestSubnetSIDs);
+  } else {
+    printf("The critical servers are: ");
+    printServers(solution->criticalServerCount,
+      solution->criticalServerSIDs);
+  }
+
+  freeExtGraph(eg);
+  freeSolution(solution);
+
+  return 0;
+}
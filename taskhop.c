@@ -0,0 +1,121 @@
+/*
+taskhop.c
+
+Driver function for k-hop neighbourhoods after the outage: how many servers
+are within k hops of a server, or of a set of servers, at each hop, and which
+ones they are.
+
+Each line of the queries file is one server or a set of servers, e.g. "4 9"
+for the servers within k hops of either 4 or 9.
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+#include "neighbourhood.h"
+
+/* Hops searched if none are given. */
+#define DEFAULTHOPS 2
+
+/* Reads every query in queryFile, returning how many there are. */
+static int readQueries(FILE *queryFile, int **querySizes, int ***querySources){
+  int numQueries = 0, allocated = 0, count, value, used, offset;
+  char *line = NULL;
+  size_t size = 0;
+  *querySizes = NULL;
+  *querySources = NULL;
+  while(getline(&line, &size, queryFile) != -1){
+    /* Counted first so the servers fit in one allocation. */
+    count = 0;
+    for(offset = 0; sscanf(line + offset, "%d%n", &value, &used) == 1;
+      offset += used){
+      count++;
+    }
+    if(count == 0) continue;
+    if(numQueries == allocated){
+      allocated = allocated > 0 ? 2 * allocated : 16;
+      *querySizes = (int *) realloc(*querySizes, sizeof(int) * allocated);
+      assert(*querySizes);
+      *querySources = (int **) realloc(*querySources,
+        sizeof(int *) * allocated);
+      assert(*querySources);
+    }
+    (*querySizes)[numQueries] = count;
+    (*querySources)[numQueries] = (int *) malloc(sizeof(int) * count);
+    assert((*querySources)[numQueries]);
+    count = 0;
+    for(offset = 0; sscanf(line + offset, "%d%n", &value, &used) == 1;
+      offset += used){
+      (*querySources)[numQueries][count++] = value;
+    }
+    numQueries++;
+  }
+  free(line);
+  return numQueries;
+}
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt "
+      "tests/hops-1.txt [k] [list] < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int maxHops = DEFAULTHOPS, listMembers = 1;
+  if(argc > 3){
+    maxHops = atoi(argv[3]);
+  }
+  if(argc > 4){
+    listMembers = atoi(argv[4]);
+  }
+  assert(maxHops >= 0);
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+  FILE *queryFile = fopen(argv[2], "r");
+  assert(queryFile);
+  int *querySizes;
+  int **querySources;
+  int numQueries = readQueries(queryFile, &querySizes, &querySources);
+  assert(fclose(queryFile) == 0);
+
+  struct neighbourhoods *n = findNeighbourhoods(problem, numQueries,
+    querySizes, querySources, maxHops, listMembers);
+
+  /* Report solution */
+  int q, h, i, total;
+  for(q = 0; q < numQueries; q++){
+    printf("From server%s", querySizes[q] == 1 ? "" : "s");
+    for(i = 0; i < querySizes[q]; i++){
+      printf(" %d", querySources[q][i]);
+    }
+    total = 0;
+    for(h = 0; h <= maxHops; h++){
+      total += (n->reached)[q * (maxHops + 1) + h];
+    }
+    printf(" within %d hop%s: %d server%s, by hop", maxHops,
+      maxHops == 1 ? "" : "s", total, total == 1 ? "" : "s");
+    for(h = 0; h <= maxHops; h++){
+      printf(" %d", (n->reached)[q * (maxHops + 1) + h]);
+    }
+    printf("\n");
+    if(listMembers){
+      printf("The servers are:");
+      for(i = (n->memberStart)[q]; i < (n->memberStart)[q + 1]; i++){
+        printf(" %d", (n->members)[i]);
+      }
+      printf("\n");
+    }
+    free(querySources[q]);
+  }
+
+  free(querySizes);
+  free(querySources);
+  freeNeighbourhoods(n);
+  freeProblem(problem);
+
+  return 0;
+}
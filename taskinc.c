@@ -0,0 +1,77 @@
+/*
+taskinc.c
+
+Driver function for Tasks 2, 3 and 7 kept up to date while new connections
+are added to the network.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+
+static void printServers(int count, int *servers){
+  int i;
+  for(i = 0; i < count; i++){
+    printf("%d", servers[i]);
+    if((i + 1) < count){
+      printf(" ");
+    }
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt "
+      "tests/connections-1.txt < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  /* Add each connection in argv[2] in turn, reporting what changed. */
+  FILE *connectionFile = fopen(argv[2], "r");
+  assert(connectionFile);
+  struct connectionReport report;
+  int start, end;
+  while(fscanf(connectionFile, "%d %d", &start, &end) == 2){
+    if(! addProblemConnection(problem, start, end, &report)){
+      printf("Connection %d %d was refused\n", start, end);
+      continue;
+    }
+    printf("After adding connection %d %d, the number of connected "
+      "subnetworks is: %d, the largest has %d servers\n", start, end,
+      report.connectedSubnets, report.largestSubnet);
+    printf("Newly critical servers: ");
+    printServers(report.newlyCriticalCount, report.newlyCritical);
+    printf("No longer critical servers: ");
+    printServers(report.noLongerCriticalCount, report.noLongerCritical);
+  }
+  assert(fclose(connectionFile) == 0);
+
+  /* Report the solutions for the network with every connection added. */
+  struct solution *solution = findSolution(problem, TASK_2);
+  printf("The number of connected subnetworks is: %d\n",
+    solution->connectedSubnets);
+  freeSolution(solution);
+
+  solution = findSolution(problem, TASK_3);
+  printf("The number of servers in the largest subnetwork is: %d\n",
+    solution->largestSubnet);
+  printf("The servers in the largest subnetwork are: ");
+  printServers(solution->largestSubnet, solution->largestSubnetSIDs);
+  freeSolution(solution);
+
+  solution = findSolution(problem, TASK_7);
+  printf("The critical servers are: ");
+  printServers(solution->criticalServerCount, solution->criticalServerSIDs);
+  freeSolution(solution);
+
+  freeProblem(problem);
+
+  return 0;
+}
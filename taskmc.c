@@ -0,0 +1,110 @@
+/*
+taskmc.c
+
+Driver function for estimating how the network holds up when servers fail at
+random on top of the outage, reporting percentiles of the largest subnetwork,
+the number of subnetworks and the diameter over many trials.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "utils.h"
+#include "graph.h"
+#include "resilience.h"
+
+/* Failure levels simulated if none are given. */
+#define DEFAULTMODEL "k"
+#define DEFAULTLEVELS "1,2,3"
+#define DEFAULTTRIALS 1000
+/* Seed for every trial's random stream. */
+#define TRIALSEED 20007
+
+/* Percentiles reported, after the minimum. */
+static const int percents[] = {5, 25, 50, 75, 95, 100};
+#define NUMPERCENTS 6
+
+static void printMeasure(const char *name, int results[], int trials){
+  int i;
+  printf("%-20s %6d", name, results[0]);
+  for(i = 0; i < NUMPERCENTS; i++){
+    printf(" %6d", resiliencePercentile(results, trials, percents[i]));
+  }
+  printf(" %8.2f\n", resilienceMean(results, trials));
+}
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [p|k] "
+      "[level,level,...] [trials] [threads] < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  const char *modelName = DEFAULTMODEL;
+  char *level, *levels = strdup(DEFAULTLEVELS);
+  assert(levels);
+  int trials = DEFAULTTRIALS;
+  int numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  enum failureModel model;
+  if(argc > 2){
+    modelName = argv[2];
+  }
+  if(argc > 3){
+    free(levels);
+    levels = strdup(argv[3]);
+    assert(levels);
+  }
+  if(argc > 4){
+    trials = atoi(argv[4]);
+  }
+  if(argc > 5){
+    numThreads = atoi(argv[5]);
+  }
+  if(strcmp(modelName, "p") == 0){
+    model = FAILURE_PROBABILITY;
+  } else if(strcmp(modelName, "k") == 0){
+    model = FAILURE_COUNT;
+  } else {
+    fprintf(stderr, "Failures are either p (a probability per server) or k "
+      "(a number of servers)\n");
+    exit(EXIT_FAILURE);
+  }
+  if(trials < 1){
+    fprintf(stderr, "At least one trial is needed\n");
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  /* Report solution */
+  int first = 1;
+  for(level = strtok(levels, ","); level; level = strtok(NULL, ",")){
+    struct resilience *r = findResilience(problem, model, atof(level), trials,
+      numThreads, TRIALSEED);
+    if(! first){
+      printf("\n");
+    }
+    first = 0;
+    if(model == FAILURE_PROBABILITY){
+      printf("Over %d trials of each server failing with probability %.2f "
+        "after the outage:\n", trials, atof(level));
+    } else {
+      printf("Over %d trials of %d server%s failing at random after the "
+        "outage:\n", trials, atoi(level), atoi(level) == 1 ? "" : "s");
+    }
+    printf("%-20s %6s %6s %6s %6s %6s %6s %6s %8s\n", "Measure", "Min", "p5",
+      "p25", "p50", "p75", "p95", "Max", "Mean");
+    printMeasure("Largest subnetwork", r->largestSubnet, trials);
+    printMeasure("Subnetworks", r->connectedSubnets, trials);
+    printMeasure("Diameter", r->diameter, trials);
+    freeResilience(r);
+  }
+
+  free(levels);
+  freeProblem(problem);
+
+  return 0;
+}
@@ -0,0 +1,221 @@
+/*
+taskreplay.c
+
+Driver function which runs a recorded trace again, reporting how long each
+kind of request took.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+#include "trace.h"
+
+#define DEFAULTREPEATS 1
+/* Longest word expected in a trace. */
+#define MAXWORD 16
+
+/* The kinds of request timed, the problem parts first in the order of enum
+  problemPart. */
+enum requestKind {
+  REQUEST_WITHIN=NUMTRACEPARTS,
+  REQUEST_CONNECT,
+  REQUEST_CHANGES,
+  NUMREQUESTKINDS
+};
+
+static const char *requestNames[NUMREQUESTKINDS] = {"Task 2", "Task 3", "Task 4", "Task 7",
+  "Task 4w", "Eccentricity", "Within", "Connect", "Changes"};
+
+/* Milliseconds taken by every request of one kind. */
+struct latencies {
+  int count;
+  int allocated;
+  double *milliseconds;
+};
+
+static void addLatency(struct latencies *l, double milliseconds){
+  if(l->count == l->allocated){
+    l->allocated = l->allocated > 0 ? 2 * l->allocated : 16;
+    l->milliseconds = (double *) realloc(l->milliseconds,
+      sizeof(double) * l->allocated);
+    assert(l->milliseconds);
+  }
+  (l->milliseconds)[l->count++] = milliseconds;
+}
+
+static int cmpDouble(const void *a, const void *b){
+  double x = *((const double *) a), y = *((const double *) b);
+  return (x > y) - (x < y);
+}
+
+/* Nearest rank percentile of sorted latencies. */
+static double percentile(struct latencies *l, int percent){
+  int rank = (l->count * percent + 99) / 100;
+  if(rank < 1){
+    rank = 1;
+  }
+  return (l->milliseconds)[rank - 1];
+}
+
+/* Copies count integers from the trace to out, separated by spaces and ending
+  the line. */
+static void copyInts(FILE *trace, FILE *out, int count){
+  int i, value;
+  for(i = 0; i < count; i++){
+    assert(fscanf(trace, "%d", &value) == 1);
+    fprintf(out, i > 0 ? " %d" : "%d", value);
+  }
+  fprintf(out, "\n");
+}
+
+/* Reads a network and its outage from the trace into a new problem. */
+static struct graphProblem *replayNetwork(FILE *trace){
+  int numServers, numConnections, outageCount, i;
+  char word[MAXWORD];
+  struct graphProblem *problem;
+  FILE *networkFile = tmpfile();
+  assert(networkFile);
+  FILE *outageFile = tmpfile();
+  assert(outageFile);
+  assert(fscanf(trace, "%d %d", &numServers, &numConnections) == 2);
+  fprintf(networkFile, "%d %d\n", numServers, numConnections);
+  for(i = 0; i < numConnections; i++){
+    copyInts(trace, networkFile, 3);
+  }
+  /* The outage is always recorded straight after its network. */
+  assert(fscanf(trace, "%15s %d", word, &outageCount) == 2);
+  assert(strcmp(word, "outage") == 0);
+  fprintf(outageFile, "%d\n", outageCount);
+  copyInts(trace, outageFile, outageCount);
+  rewind(networkFile);
+  rewind(outageFile);
+  problem = readProblem(outageFile, networkFile);
+  assert(fclose(networkFile) == 0);
+  assert(fclose(outageFile) == 0);
+  return problem;
+}
+
+/* Reads count change log lines from the trace into a temporary change log. */
+static FILE *replayChangeLog(FILE *trace, int count){
+  int i;
+  char op;
+  FILE *changeFile = tmpfile();
+  assert(changeFile);
+  for(i = 0; i < count; i++){
+    assert(fscanf(trace, " %c", &op) == 1);
+    fprintf(changeFile, "%c ", op);
+    if(op == '+'){
+      copyInts(trace, changeFile, 3);
+    } else if(op == '-'){
+      copyInts(trace, changeFile, 2);
+    } else {
+      assert(op == 'x');
+      copyInts(trace, changeFile, 1);
+    }
+  }
+  rewind(changeFile);
+  return changeFile;
+}
+
+/* Runs every request in the trace, adding the time each took to times, and
+  returns the number of networks loaded. */
+static int replay(FILE *trace, struct latencies times[]){
+  int networks = 0, value, start, end, part;
+  double begin;
+  char word[MAXWORD];
+  struct graphProblem *problem = NULL;
+  struct connectionReport report;
+  FILE *changeFile;
+  while(fscanf(trace, "%15s", word) == 1){
+    if(strcmp(word, "network") == 0){
+      freeProblem(problem);
+      problem = replayNetwork(trace);
+      networks++;
+      continue;
+    }
+    assert(problem);
+    if(strcmp(word, "query") == 0){
+      assert(fscanf(trace, "%15s", word) == 1);
+      for(part = 0; part < NUMTRACEPARTS; part++){
+        if(strcmp(word, tracePartNames[part]) == 0) break;
+      }
+      assert(part < NUMTRACEPARTS);
+      begin = nowMilliseconds();
+      freeSolution(findSolution(problem, (enum problemPart) part));
+      addLatency(&(times[part]), nowMilliseconds() - begin);
+    } else if(strcmp(word, "within") == 0){
+      assert(fscanf(trace, "%d", &value) == 1);
+      begin = nowMilliseconds();
+      freeSolution(findDiameterWithin(problem, value));
+      addLatency(&(times[REQUEST_WITHIN]), nowMilliseconds() - begin);
+    } else if(strcmp(word, "connect") == 0){
+      assert(fscanf(trace, "%d %d", &start, &end) == 2);
+      begin = nowMilliseconds();
+      addProblemConnection(problem, start, end, &report);
+      addLatency(&(times[REQUEST_CONNECT]), nowMilliseconds() - begin);
+    } else {
+      assert(strcmp(word, "changes") == 0);
+      assert(fscanf(trace, "%d", &value) == 1);
+      changeFile = replayChangeLog(trace, value);
+      begin = nowMilliseconds();
+      applyChangeLog(problem, changeFile);
+      addLatency(&(times[REQUEST_CHANGES]), nowMilliseconds() - begin);
+      assert(fclose(changeFile) == 0);
+    }
+  }
+  freeProblem(problem);
+  return networks;
+}
+
+int main(int argc, char **argv){
+  int i, j, repeats = DEFAULTREPEATS, networks = 0, requests = 0;
+  double total = 0;
+  struct latencies times[NUMREQUESTKINDS];
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s trace.txt [repeats]\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  if(argc > 2){
+    repeats = atoi(argv[2]);
+  }
+  /* The trace being replayed may be the one named for recording, which
+    would then grow with every request replayed. */
+  suppressEnvironmentRecorder();
+  memset(times, 0, sizeof(times));
+  FILE *trace = fopen(argv[1], "r");
+  assert(trace);
+  for(i = 0; i < repeats; i++){
+    rewind(trace);
+    networks += replay(trace, times);
+  }
+  assert(fclose(trace) == 0);
+
+  for(i = 0; i < NUMREQUESTKINDS; i++){
+    requests += times[i].count;
+    for(j = 0; j < times[i].count; j++){
+      total += (times[i].milliseconds)[j];
+    }
+  }
+  /* Throughput counts only the time spent answering requests, not loading
+    networks. */
+  printf("Replayed %d requests on %d networks in %.3f ms", requests, networks,
+    total);
+  if(total > 0){
+    printf(", %.1f requests per second", requests * 1000.0 / total);
+  }
+  printf("\n");
+  printf("%-14s %8s %10s %10s %10s %10s\n", "Request", "Count", "p50 ms",
+    "p90 ms", "p99 ms", "max ms");
+  for(i = 0; i < NUMREQUESTKINDS; i++){
+    if(times[i].count == 0) continue;
+    qsort(times[i].milliseconds, times[i].count, sizeof(double), cmpDouble);
+    printf("%-14s %8d %10.3f %10.3f %10.3f %10.3f\n", requestNames[i],
+      times[i].count, percentile(&(times[i]), 50), percentile(&(times[i]), 90),
+      percentile(&(times[i]), 99), percentile(&(times[i]), 100));
+    free(times[i].milliseconds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+/*
+tasksep.c
+
+Driver function for the two server failure report: every pair of servers,
+neither critical on its own, whose joint failure disconnects the network.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include "utils.h"
+#include "graph.h"
+#include "separation.h"
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [threads] "
+      "< tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if(argc > 2){
+    numThreads = atoi(argv[2]);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  struct separationPairs *pairs = findSeparationPairs(problem, numThreads);
+
+  /* Report solution */
+  printf("The number of separation pairs is: %d\n", pairs->count);
+  int i;
+  for(i = 0; i < pairs->count; i++){
+    printf("Servers %d and %d: %d subnetworks, the largest has %d servers\n",
+      (pairs->pairs)[i].first, (pairs->pairs)[i].second,
+      (pairs->pairs)[i].connectedSubnets, (pairs->pairs)[i].largestSubnet);
+  }
+
+  freeProblem(problem);
+  freeSeparationPairs(pairs);
+
+  return 0;
+}
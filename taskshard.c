@@ -0,0 +1,78 @@
+/*
+taskshard.c
+
+Driver function for Tasks 2, 3 and 4 with the servers split between worker
+processes sharing memory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+
+/* Worker processes used if no number is given. */
+#define DEFAULTSHARDS 4
+
+static void printServers(int count, int *servers){
+  int i;
+  for(i = 0; i < count; i++){
+    printf("%d", servers[i]);
+    if((i + 1) < count){
+      printf(" ");
+    }
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s 2|3|4 tests/network-1.txt "
+      "[workers] < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int task = atoi(argv[1]);
+  int numShards = DEFAULTSHARDS;
+  if(argc > 3){
+    numShards = atoi(argv[3]);
+  }
+  enum problemPart part;
+  if(task == 2){
+    part = TASK_2;
+  } else if(task == 3){
+    part = TASK_3;
+  } else if(task == 4){
+    part = TASK_4;
+  } else {
+    fprintf(stderr, "Only tasks 2, 3 and 4 can be run in sharded mode\n");
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[2] (network info). */
+  FILE *networkFile = fopen(argv[2], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  struct solution *solution = findShardedSolution(problem, part, numShards);
+
+  /* Report solution in the same form as the single process drivers. */
+  if(part == TASK_2){
+    printf("Before the outage, the number of connected subnetworks is: %d\n",
+      solution->connectedSubnets);
+  } else if(part == TASK_3){
+    printf("Before the outage, the number of servers in the largest "
+           "subnetwork is: %d\n", solution->largestSubnet);
+    printf("The servers in the largest subnetwork are: ");
+    printServers(solution->largestSubnet, solution->largestSubnetSIDs);
+  } else {
+    printf("After the outage, the largest diameter in any of the subnetworks "
+           "is: %d\n", solution->postOutageDiameter);
+    printf("The path is: ");
+    printServers(solution->postOutageDiameterCount,
+      solution->postOutageDiameterSIDs);
+  }
+
+  freeProblem(problem);
+  freeSolution(solution);
+
+  return 0;
+}
@@ -0,0 +1,50 @@
+/*
+tasktri.c
+
+Driver function for triangle counting after the outage: the triangles of
+connections in the network and each server's clustering coefficient, the
+fraction of pairs of its neighbours which are connected to each other.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include "utils.h"
+#include "graph.h"
+#include "triangles.h"
+
+int main(int argc, char **argv){
+  if(argc < 2){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt [threads] "
+      "< tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if(argc > 2){
+    numThreads = atoi(argv[2]);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  struct triangles *t = findTriangles(problem, numThreads);
+
+  /* Report solution */
+  int v;
+  printf("After the outage, the number of triangles is: %lld\n", t->total);
+  printf("The transitivity is: %.4f\n", t->transitivity);
+  printf("The average clustering coefficient is: %.4f\n",
+    t->averageClustering);
+  for(v = 0; v < t->numServers; v++){
+    if((t->count)[v] < 0) continue;
+    printf("Server %d: %lld triangle%s, clustering %.4f\n", v, (t->count)[v],
+      (t->count)[v] == 1 ? "" : "s", (t->clustering)[v]);
+  }
+
+  freeProblem(problem);
+  freeTriangles(t);
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+/*
+taskupdate.c
+
+Driver function for Tasks 2, 3, 4 and 7 on a network after a change log has
+been applied to it.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "utils.h"
+#include "graph.h"
+
+static void printServers(int count, int *servers){
+  int i;
+  for(i = 0; i < count; i++){
+    printf("%d", servers[i]);
+    if((i + 1) < count){
+      printf(" ");
+    }
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv){
+  if(argc < 3){
+    fprintf(stderr, "Run in the form %s tests/network-1.txt "
+      "tests/changes-1.txt < tests/outage-1.txt\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  /* Read the problem in from stdin (outage info) and argv[1] (network info). */
+  FILE *networkFile = fopen(argv[1], "r");
+  assert(networkFile);
+  struct graphProblem *problem = readProblem(stdin, networkFile);
+  assert(fclose(networkFile) == 0);
+
+  /* Apply the changes in argv[2] to the loaded network. */
+  FILE *changeFile = fopen(argv[2], "r");
+  assert(changeFile);
+  int applied = applyChangeLog(problem, changeFile);
+  assert(fclose(changeFile) == 0);
+  printf("The number of changes applied is: %d\n", applied);
+
+  /* Find and report the solutions on the changed network. */
+  struct solution *solution = findSolution(problem, TASK_2);
+  printf("Before the outage, the number of connected subnetworks is: %d\n",
+    solution->connectedSubnets);
+  freeSolution(solution);
+
+  solution = findSolution(problem, TASK_3);
+  printf("Before the outage, the number of servers in the largest subnetwork is"
+         ": %d\n", solution->largestSubnet);
+  printf("The servers in the largest subnetwork are: ");
+  printServers(solution->largestSubnet, solution->largestSubnetSIDs);
+  freeSolution(solution);
+
+  solution = findSolution(problem, TASK_4);
+  printf("After the outage, the largest diameter in any of the subnetworks is:"
+         " %d\n", solution->postOutageDiameter);
+  printf("The path is: ");
+  printServers(solution->postOutageDiameterCount,
+    solution->postOutageDiameterSIDs);
+  freeSolution(solution);
+
+  solution = findSolution(problem, TASK_7);
+  printf("The critical servers are: ");
+  printServers(solution->criticalServerCount, solution->criticalServerSIDs);
+  freeSolution(solution);
+
+  freeProblem(problem);
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+trace.c
+
+Workload traces
+
+Implementations for recording networks, outages and requests to a trace file,
+optionally with every server renumbered.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include "graph.h"
+#include "trace.h"
+
+struct traceRecorder {
+  FILE *file;
+  int anonymise;
+  /* New number of each server in the current network, when anonymising. */
+  int *relabel;
+  int numServers;
+  /* State of the xorshift generator used to shuffle the numbers. */
+  unsigned long long random;
+};
+
+static struct traceRecorder *recorder = NULL;
+static int recorderChecked = 0;
+
+const char *const tracePartNames[NUMTRACEPARTS] = {"2", "3", "4", "7", "4w",
+  "ecc"};
+
+static unsigned long long nextRandom(struct traceRecorder *t){
+  t->random ^= t->random << 13;
+  t->random ^= t->random >> 7;
+  t->random ^= t->random << 17;
+  return t->random;
+}
+
+/* Servers outside the network (such as the datacentre) keep their number. */
+static int relabel(struct traceRecorder *t, int v){
+  if(! t->relabel || v < 0 || v >= t->numServers){
+    return v;
+  }
+  return (t->relabel)[v];
+}
+
+struct traceRecorder *openTraceRecorder(const char *path, int anonymise){
+  struct traceRecorder *t = (struct traceRecorder *)
+    malloc(sizeof(struct traceRecorder));
+  assert(t);
+  t->file = fopen(path, "a");
+  assert(t->file);
+  t->anonymise = anonymise;
+  t->relabel = NULL;
+  t->numServers = 0;
+  /* Not reproducible, so the original numbers can't be worked back to. */
+  t->random = ((unsigned long long) time(NULL) << 20) ^
+    (unsigned long long) getpid() ^ (unsigned long long) (size_t) t;
+  if(t->random == 0){
+    t->random = 1;
+  }
+  return t;
+}
+
+static void closeEnvironmentRecorder(void){
+  closeTraceRecorder(recorder);
+  recorder = NULL;
+}
+
+struct traceRecorder *environmentRecorder(void){
+  const char *path, *anonymise;
+  if(recorderChecked){
+    return recorder;
+  }
+  recorderChecked = 1;
+  path = getenv(TRACEVARIABLE);
+  if(! path || path[0] == '\0'){
+    return NULL;
+  }
+  anonymise = getenv(ANONYMISEVARIABLE);
+  recorder = openTraceRecorder(path, anonymise && strcmp(anonymise, "0") != 0);
+  atexit(closeEnvironmentRecorder);
+  return recorder;
+}
+
+void suppressEnvironmentRecorder(void){
+  if(recorder){
+    closeEnvironmentRecorder();
+  }
+  recorderChecked = 1;
+}
+
+void traceNetwork(struct traceRecorder *t, int numServers,
+  int numConnections){
+  int i, j, swap;
+  free(t->relabel);
+  t->relabel = NULL;
+  t->numServers = numServers;
+  if(t->anonymise && numServers > 0){
+    /* Fisher-Yates shuffle of the server numbers. */
+    t->relabel = (int *) malloc(sizeof(int) * numServers);
+    assert(t->relabel);
+    for(i = 0; i < numServers; i++){
+      (t->relabel)[i] = i;
+    }
+    for(i = numServers - 1; i > 0; i--){
+      j = (int) (nextRandom(t) % (unsigned long long) (i + 1));
+      swap = (t->relabel)[i];
+      (t->relabel)[i] = (t->relabel)[j];
+      (t->relabel)[j] = swap;
+    }
+  }
+  fprintf(t->file, "network %d %d\n", numServers, numConnections);
+}
+
+void traceConnection(struct traceRecorder *t, int start, int end, int weight){
+  fprintf(t->file, "%d %d %d\n", relabel(t, start), relabel(t, end), weight);
+}
+
+void traceOutage(struct traceRecorder *t, int outageCount, int *outageSIDs){
+  int i;
+  fprintf(t->file, "outage %d", outageCount);
+  for(i = 0; i < outageCount; i++){
+    fprintf(t->file, " %d", relabel(t, outageSIDs[i]));
+  }
+  fprintf(t->file, "\n");
+  fflush(t->file);
+}
+
+void traceQuery(struct traceRecorder *t, enum problemPart part){
+  fprintf(t->file, "query %s\n", tracePartNames[part]);
+  fflush(t->file);
+}
+
+void traceDiameterWithin(struct traceRecorder *t, int milliseconds){
+  fprintf(t->file, "within %d\n", milliseconds);
+  fflush(t->file);
+}
+
+void traceConnect(struct traceRecorder *t, int start, int end){
+  fprintf(t->file, "connect %d %d\n", relabel(t, start), relabel(t, end));
+  fflush(t->file);
+}
+
+void traceChanges(struct traceRecorder *t, struct edgeChange *changes,
+  int count){
+  int i;
+  fprintf(t->file, "changes %d\n", count);
+  for(i = 0; i < count; i++){
+    if(changes[i].kind == ADD_CONNECTION){
+      fprintf(t->file, "+ %d %d %d\n", relabel(t, changes[i].start),
+        relabel(t, changes[i].end), changes[i].weight);
+    } else if(changes[i].kind == DELETE_CONNECTION){
+      fprintf(t->file, "- %d %d\n", relabel(t, changes[i].start),
+        relabel(t, changes[i].end));
+    } else {
+      fprintf(t->file, "x %d\n", relabel(t, changes[i].start));
+    }
+  }
+  fflush(t->file);
+}
+
+void closeTraceRecorder(struct traceRecorder *t){
+  if(! t){
+    return;
+  }
+  assert(fclose(t->file) == 0);
+  free(t->relabel);
+  free(t);
+}
@@ -0,0 +1,73 @@
+/*
+trace.h
+
+Visible structs and functions for recording the networks loaded and the
+questions asked of them to a trace file, which taskreplay runs again.
+
+Each record is a line starting with a word:
+  network n m    followed by the m connections "a b cost", one per line
+  outage k s...  the outage of k servers
+  query t        a solution for task t (2, 3, 4, 7, 4w or ecc)
+  within ms      the diameter found within ms milliseconds
+  connect a b    a connection added to the live network
+  changes k      followed by k change log lines ("+ a b cost", "- a b", "x s")
+Records after a network line belong to that network. Traces are appended to,
+  so the runs of many programs can be collected in one file.
+*/
+/* Because we use enum problemPart and struct edgeChange in this file, we
+  should include graph.h here. */
+#include "graph.h"
+
+/* Programs record to the file this environment variable names, if set. */
+#define TRACEVARIABLE "GRAPH_TRACE"
+/* If this environment variable is set to anything but 0, the servers in every
+  network recorded are given new numbers in a random order. */
+#define ANONYMISEVARIABLE "GRAPH_TRACE_ANONYMISE"
+
+/* Problem parts which can be asked for in a trace, one for each value of enum
+  problemPart. */
+#define NUMTRACEPARTS (TASK_ECCENTRICITY + 1)
+
+/* Name each problem part is recorded under, in the order of enum
+  problemPart. */
+extern const char *const tracePartNames[NUMTRACEPARTS];
+
+struct traceRecorder;
+
+/* Opens path to append records to, renumbering servers if anonymise is set. */
+struct traceRecorder *openTraceRecorder(const char *path, int anonymise);
+
+/* Returns the recorder named by the environment, opening it the first time it
+  is asked for, or NULL if nothing is to be recorded. It is closed when the
+  program exits. */
+struct traceRecorder *environmentRecorder(void);
+
+/* Stops environmentRecorder recording anything more in this program, for
+  programs which replay a trace and so would record it over again. */
+void suppressEnvironmentRecorder(void);
+
+/* Starts a network of numServers servers, whose numConnections connections
+  must be recorded next. */
+void traceNetwork(struct traceRecorder *t, int numServers, int numConnections);
+
+/* Records one connection of the current network. */
+void traceConnection(struct traceRecorder *t, int start, int end, int weight);
+
+/* Records the outage for the current network. */
+void traceOutage(struct traceRecorder *t, int outageCount, int *outageSIDs);
+
+/* Records a request for the solution to part. */
+void traceQuery(struct traceRecorder *t, enum problemPart part);
+
+/* Records a request for the diameter within the given milliseconds. */
+void traceDiameterWithin(struct traceRecorder *t, int milliseconds);
+
+/* Records a connection added to the live network. */
+void traceConnect(struct traceRecorder *t, int start, int end);
+
+/* Records a batch of changes made to the network. */
+void traceChanges(struct traceRecorder *t, struct edgeChange *changes,
+  int count);
+
+/* Closes the trace file and frees the recorder. */
+void closeTraceRecorder(struct traceRecorder *t);
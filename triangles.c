@@ -0,0 +1,285 @@
+/*
+triangles.c
+
+Triangle counting and clustering
+
+Implementations for counting triangles over degree ordered, sorted forward
+adjacency lists, with the servers split between threads.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "graph.h"
+#include "triangles.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Sorted neighbour lists: the neighbours of v are list[start[v]] to
+  list[start[v + 1] - 1]. */
+struct sortedRows {
+  int *start;
+  int *list;
+};
+
+/* One thread's share of the servers, and its own totals. */
+struct triangleThread {
+  pthread_t thread;
+  /* Forward lists, numbered by rank. */
+  struct sortedRows *forward;
+  int numRanked;
+  /* Ranks first, first + step, ... are this thread's. */
+  int first;
+  int step;
+  /* Triangles of each rank found by this thread. */
+  long long *count;
+  /* Shared forward neighbours of the current connection. */
+  int *shared;
+};
+
+/* Writes the values in both of the sorted lists a and b to shared, returning
+  how many there are. */
+static int intersect(const int *a, int sizeA, const int *b, int sizeB,
+  int shared[]){
+  int i = 0, j = 0, count = 0;
+#ifdef __SSE2__
+  __m128i blockA, blockB, equal;
+  int mask, lastA, lastB;
+  /* Compare each block of four from a with a block of four from b in every
+    rotation, then move on past whichever block ends lower (both if they end
+    on the same value). Each pair of blocks is compared at most once. */
+  while(i + 4 <= sizeA && j + 4 <= sizeB){
+    blockA = _mm_loadu_si128((const __m128i *) &(a[i]));
+    blockB = _mm_loadu_si128((const __m128i *) &(b[j]));
+    equal = _mm_cmpeq_epi32(blockA, blockB);
+    equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA,
+      _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1))));
+    equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA,
+      _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2))));
+    equal = _mm_or_si128(equal, _mm_cmpeq_epi32(blockA,
+      _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3))));
+    for(mask = _mm_movemask_ps(_mm_castsi128_ps(equal)); mask;
+      mask &= mask - 1){
+      shared[count++] = a[i + __builtin_ctz(mask)];
+    }
+    lastA = a[i + 3];
+    lastB = b[j + 3];
+    if(lastA <= lastB){
+      i += 4;
+    }
+    if(lastB <= lastA){
+      j += 4;
+    }
+  }
+#endif
+  /* Merge whatever is left, which no block comparison has covered. */
+  while(i < sizeA && j < sizeB){
+    if(a[i] < b[j]){
+      i++;
+    } else if(a[i] > b[j]){
+      j++;
+    } else {
+      shared[count++] = a[i];
+      i++;
+      j++;
+    }
+  }
+  return count;
+}
+
+static void *triangleWorker(void *arg){
+  struct triangleThread *t = (struct triangleThread *) arg;
+  int *start = t->forward->start, *list = t->forward->list;
+  int u, v, k, i, found;
+  for(u = t->first; u < t->numRanked; u += t->step){
+    for(k = start[u]; k < start[u + 1]; k++){
+      v = list[k];
+      found = intersect(&(list[start[u]]), start[u + 1] - start[u],
+        &(list[start[v]]), start[v + 1] - start[v], t->shared);
+      (t->count)[u] += found;
+      (t->count)[v] += found;
+      for(i = 0; i < found; i++){
+        (t->count)[(t->shared)[i]]++;
+      }
+    }
+  }
+  return NULL;
+}
+
+/* Fills rows with the distinct surviving neighbours of every server, sorted,
+  and degree with how many there are. */
+static void sortNeighbours(struct graph *g, int numServers, int outageMask[],
+  struct sortedRows *rows, int degree[]){
+  struct adjacency *adj = getAdjacency(g);
+  int u, w, k, next = 0, count, entries = 0;
+  for(u = 0; u < numServers; u++){
+    entries += (adj->len)[u];
+  }
+  rows->start = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(rows->start);
+  rows->list = (int *) malloc(sizeof(int) * (entries + 1));
+  assert(rows->list);
+  for(u = 0; u < numServers; u++){
+    (rows->start)[u] = next;
+    degree[u] = -1;
+    if(outageMask && outageMask[u]) continue;
+    count = 0;
+    for(k = (adj->start)[u]; k < (adj->start)[u] + (adj->len)[u]; k++){
+      w = (adj->target)[k];
+      if(w == u || w >= numServers || (outageMask && outageMask[w])){
+        continue;
+      }
+      (rows->list)[next + count++] = w;
+    }
+    qsort(&((rows->list)[next]), count, sizeof(int), cmpfunc);
+    /* Repeated connections make one pair of neighbours. */
+    degree[u] = 0;
+    for(k = 0; k < count; k++){
+      if(k == 0 || (rows->list)[next + k] != (rows->list)[next + k - 1]){
+        (rows->list)[next + degree[u]++] = (rows->list)[next + k];
+      }
+    }
+    next += degree[u];
+  }
+  (rows->start)[numServers] = next;
+}
+
+struct triangles *getTriangles(struct graph *g, int numServers,
+  int outageMask[], int numThreads){
+  struct triangles *t = (struct triangles *) malloc(sizeof(struct triangles));
+  assert(t);
+  struct sortedRows rows, forward;
+  int i, u, v, k, r, next, numRanked = 0, longest = 0;
+  double pairs = 0, clusteringTotal = 0;
+
+  t->numServers = numServers;
+  t->degree = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(t->degree);
+  t->count = (long long *) malloc(sizeof(long long) * (numServers + 1));
+  assert(t->count);
+  t->clustering = (double *) malloc(sizeof(double) * (numServers + 1));
+  assert(t->clustering);
+  sortNeighbours(g, numServers, outageMask, &rows, t->degree);
+
+  /* Rank the survivors by degree, fewest first and ties going to the smaller
+    server, with a counting sort. */
+  int *rank = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(rank);
+  int *byRank = (int *) malloc(sizeof(int) * (numServers + 1));
+  assert(byRank);
+  int *first = (int *) calloc(numServers + 2, sizeof(int));
+  assert(first);
+  for(u = 0; u < numServers; u++){
+    if((t->degree)[u] >= 0){
+      first[(t->degree)[u] + 1]++;
+      numRanked++;
+    }
+  }
+  for(i = 1; i <= numServers + 1; i++){
+    first[i] += first[i - 1];
+  }
+  for(u = 0; u < numServers; u++){
+    rank[u] = -1;
+    if((t->degree)[u] >= 0){
+      rank[u] = first[(t->degree)[u]]++;
+      byRank[rank[u]] = u;
+    }
+  }
+  free(first);
+
+  /* Keep each connection only from its lower ranked end, as sorted ranks. */
+  forward.start = (int *) malloc(sizeof(int) * (numRanked + 1));
+  assert(forward.start);
+  forward.list = (int *) malloc(sizeof(int) *
+    (rows.start[numServers] / 2 + 1));
+  assert(forward.list);
+  next = 0;
+  for(r = 0; r < numRanked; r++){
+    u = byRank[r];
+    forward.start[r] = next;
+    for(k = rows.start[u]; k < rows.start[u] + (t->degree)[u]; k++){
+      v = rank[rows.list[k]];
+      if(v > r){
+        forward.list[next++] = v;
+      }
+    }
+    qsort(&(forward.list[forward.start[r]]), next - forward.start[r],
+      sizeof(int), cmpfunc);
+    if(next - forward.start[r] > longest){
+      longest = next - forward.start[r];
+    }
+  }
+  forward.start[numRanked] = next;
+  free(rows.start);
+  free(rows.list);
+
+  if(numThreads > numRanked){
+    numThreads = numRanked;
+  }
+  if(numThreads < 1){
+    numThreads = 1;
+  }
+  struct triangleThread *threads = (struct triangleThread *)
+    malloc(sizeof(struct triangleThread) * numThreads);
+  assert(threads);
+  for(i = 0; i < numThreads; i++){
+    threads[i].forward = &forward;
+    threads[i].numRanked = numRanked;
+    threads[i].first = i;
+    threads[i].step = numThreads;
+    threads[i].count = (long long *) calloc(numRanked + 1, sizeof(long long));
+    assert(threads[i].count);
+    threads[i].shared = (int *) malloc(sizeof(int) * (longest + 1));
+    assert(threads[i].shared);
+    assert(pthread_create(&(threads[i].thread), NULL, triangleWorker,
+      &(threads[i])) == 0);
+  }
+
+  for(u = 0; u < numServers; u++){
+    (t->count)[u] = rank[u] >= 0 ? 0 : -1;
+  }
+  for(i = 0; i < numThreads; i++){
+    assert(pthread_join(threads[i].thread, NULL) == 0);
+    for(r = 0; r < numRanked; r++){
+      (t->count)[byRank[r]] += (threads[i].count)[r];
+    }
+    free(threads[i].count);
+    free(threads[i].shared);
+  }
+  free(threads);
+  free(forward.start);
+  free(forward.list);
+
+  /* Every triangle was counted once at each of its three servers. */
+  t->total = 0;
+  for(u = 0; u < numServers; u++){
+    v = (t->degree)[u];
+    if(v < 0){
+      (t->clustering)[u] = -1;
+      continue;
+    }
+    t->total += (t->count)[u];
+    (t->clustering)[u] = v < 2 ? 0 :
+      2.0 * (t->count)[u] / ((double) v * (v - 1));
+    clusteringTotal += (t->clustering)[u];
+    pairs += (double) v * (v - 1) / 2;
+  }
+  t->total /= 3;
+  t->transitivity = pairs > 0 ? 3.0 * t->total / pairs : 0;
+  t->averageClustering = numRanked > 0 ? clusteringTotal / numRanked : 0;
+  free(rank);
+  free(byRank);
+  return t;
+}
+
+void freeTriangles(struct triangles *t){
+  if(! t){
+    return;
+  }
+  free(t->count);
+  free(t->degree);
+  free(t->clustering);
+  free(t);
+}
@@ -0,0 +1,48 @@
+/*
+triangles.h
+
+Visible structs and functions for triangle counting and clustering: how many
+triangles of connections each server is part of after the outage, and how
+close its neighbours come to all being connected to each other.
+
+Each connection is pointed from the server with fewer connections to the one
+  with more (the smaller server first on ties), and every server's forward
+  neighbours are sorted in that order. A triangle is then found exactly once,
+  from its first server, as a forward neighbour shared by the two ends of one
+  of its connections. The shared neighbours are found with a sorted list
+  intersection, comparing blocks of four with SSE2 where it is available and
+  merging otherwise. The servers are split between threads, each counting
+  into its own totals.
+*/
+/* Because we use struct graph in this file, we should include graph.h here. */
+#include "graph.h"
+
+/* Triangles and clustering of every server. */
+#ifndef TRIANGLES_STRUCT
+#define TRIANGLES_STRUCT
+struct triangles {
+  int numServers;
+  /* Triangles in the network after the outage. */
+  long long total;
+  /* Per server, the triangles it is part of and its distinct surviving
+    neighbours. -1 for servers affected by the outage. */
+  long long *count;
+  int *degree;
+  /* Per server, the fraction of pairs of its neighbours which are connected,
+    0 with fewer than two neighbours and -1 for servers affected by the
+    outage. */
+  double *clustering;
+  /* Three times the triangles over the pairs of connections sharing a server,
+    and the mean clustering of the surviving servers. */
+  double transitivity;
+  double averageClustering;
+};
+#endif
+
+/* Counts the triangles of the servers not in outageMask (which may be NULL)
+  using numThreads threads. */
+struct triangles *getTriangles(struct graph *g, int numServers,
+  int outageMask[], int numThreads);
+
+/* Frees all memory used by t. */
+void freeTriangles(struct triangles *t);
@@ -7,9 +7,21 @@ Skeleton written by Grady Fitzpatrick for COMP20007 Assignment 1 2021
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
 #include <assert.h>
 #include "graph.h"
 #include "utils.h"
+#include "snapshot.h"
+#include "incremental.h"
+#include "shard.h"
+#include "trace.h"
+
+/* Room for changes first allocated when reading a change log. */
+#define INITIALCHANGES 32
+/* Longest connection line read. */
+#define MAXLINE 256
 
 struct graphProblem {
   int numServers;
@@ -17,12 +29,47 @@ struct graphProblem {
   int outageCount;
   int *outageSIDs;
   struct graph *graph;
+  /* Scratch space shared by every solution found for this problem. */
+  struct workspace *workspace;
+  /* Hash of the network read, and the snapshot in use (if any). */
+  unsigned long long networkHash;
+  struct snapshot *snapshot;
+  /* Subnetworks and critical servers kept up to date as connections are
+    added, NULL until the first is. */
+  struct incremental *incremental;
 };
 
+/* Reads the rest of a connection line, "start end [cost]", skipping blank
+  lines. Connections without a cost have a cost of 1. The whole line is read so
+  a second connection on the same line is caught rather than taken as a cost. */
+static void readConnection(FILE *file, int *start, int *end, int *weight){
+  char line[MAXLINE];
+  char *pos;
+  int used;
+  do {
+    assert(fgets(line, MAXLINE, file));
+    /* A line too long for the buffer would have its end read as the next. */
+    assert(strchr(line, '\n') || feof(file));
+    for(pos = line; isspace((unsigned char) *pos); pos++);
+  } while(*pos == '\0');
+  assert(sscanf(pos, "%d %d%n", start, end, &used) == 2);
+  pos += used;
+  *weight = 1;
+  if(sscanf(pos, "%d%n", weight, &used) == 1){
+    assert(*weight >= 0);
+    pos += used;
+  }
+  for(; isspace((unsigned char) *pos); pos++);
+  assert(*pos == '\0');
+}
+
 struct graphProblem *readProblem(FILE *outageFile, FILE *networkFile){
   int i;
   int startServer;
   int endServer;
+  int connection[3];
+  /* Record the problem if a trace is being made. */
+  struct traceRecorder *recorder = environmentRecorder();
   /* Allocate space for problem specification */
   struct graphProblem *problem = (struct graphProblem *)
     malloc(sizeof(struct graphProblem));
@@ -31,13 +78,26 @@ struct graphProblem *readProblem(FILE *outageFile, FILE *networkFile){
   /* First line comprises number of servers and number of connections. */
   assert(fscanf(networkFile, "%d %d", &(problem->numServers),
     &(problem->numConnections)) == 2);
+  if(recorder){
+    traceNetwork(recorder, problem->numServers, problem->numConnections);
+  }
+
+  problem->networkHash = hashInts(HASHSEED, &(problem->numServers), 1);
+  problem->networkHash = hashInts(problem->networkHash,
+    &(problem->numConnections), 1);
 
   /* Build graph number of houses + 1 because of datacentre. */
   problem->graph = newGraph(problem->numServers + 1);
   /* Add all edges to graph. */
   for(i = 0; i < problem->numConnections; i++){
-    assert(fscanf(networkFile, "%d %d", &startServer, &endServer) == 2);
-    addEdge(problem->graph, startServer, endServer);
+    readConnection(networkFile, &startServer, &endServer, &(connection[2]));
+    connection[0] = startServer;
+    connection[1] = endServer;
+    addWeightedEdge(problem->graph, startServer, endServer, connection[2]);
+    if(recorder){
+      traceConnection(recorder, startServer, endServer, connection[2]);
+    }
+    problem->networkHash = hashInts(problem->networkHash, connection, 3);
   }
 
   /* Read outage information. */
@@ -54,14 +114,262 @@ struct graphProblem *readProblem(FILE *outageFile, FILE *networkFile){
   for(i = 0; i < problem->outageCount; i++){
     assert(fscanf(outageFile, "%d", &((problem->outageSIDs)[i])) == 1);
   }
+  if(recorder){
+    traceOutage(recorder, problem->outageCount, problem->outageSIDs);
+  }
+
+  problem->workspace = NULL;
+  problem->snapshot = NULL;
+  problem->incremental = NULL;
 
   return problem;
 }
 
+int applyChangeLog(struct graphProblem *problem, FILE *changeFile){
+  int count = 0, allocated = 0, applied, record[4];
+  char op;
+  struct edgeChange *changes = NULL;
+  /* Read every change first so they can be applied as one batch. */
+  while(fscanf(changeFile, " %c", &op) == 1){
+    if(count == allocated){
+      allocated = allocated > 0 ? 2 * allocated : INITIALCHANGES;
+      changes = (struct edgeChange *) realloc(changes,
+        sizeof(struct edgeChange) * allocated);
+      assert(changes);
+    }
+    changes[count].end = -1;
+    changes[count].weight = 1;
+    if(op == '+'){
+      changes[count].kind = ADD_CONNECTION;
+      readConnection(changeFile, &(changes[count].start),
+        &(changes[count].end), &(changes[count].weight));
+    } else if(op == '-'){
+      changes[count].kind = DELETE_CONNECTION;
+      assert(fscanf(changeFile, "%d %d", &(changes[count].start),
+        &(changes[count].end)) == 2);
+    } else {
+      assert(op == 'x');
+      changes[count].kind = REMOVE_SERVER;
+      assert(fscanf(changeFile, "%d", &(changes[count].start)) == 1);
+    }
+    /* The network is now different, so is its hash. */
+    record[0] = changes[count].kind;
+    record[1] = changes[count].start;
+    record[2] = changes[count].end;
+    record[3] = changes[count].weight;
+    problem->networkHash = hashInts(problem->networkHash, record, 4);
+    count++;
+  }
+  if(environmentRecorder()){
+    traceChanges(environmentRecorder(), changes, count);
+  }
+  /* Deletions can't be followed incrementally, start again if needed. */
+  freeIncremental(problem->incremental);
+  problem->incremental = NULL;
+  applied = applyChanges(problem->graph, problem->numServers, changes,
+    count);
+  freeSnapshot(problem->snapshot);
+  problem->snapshot = NULL;
+  free(changes);
+  return applied;
+}
+
+void useSnapshot(struct graphProblem *problem, const char *path){
+  int i;
+  int *outages = (int *) malloc(sizeof(int) * (problem->outageCount + 1));
+  assert(outages);
+  /* The outage is hashed in increasing order so the order it was listed in
+    doesn't matter. */
+  for(i = 0; i < problem->outageCount; i++){
+    outages[i] = (problem->outageSIDs)[i];
+  }
+  qsort(outages, problem->outageCount, sizeof(int), cmpfunc);
+  freeSnapshot(problem->snapshot);
+  problem->snapshot = openSnapshot(path, problem->networkHash,
+    hashInts(HASHSEED, outages, problem->outageCount), problem->numServers);
+  free(outages);
+}
+
+int addProblemConnection(struct graphProblem *problem, int start, int end,
+  struct connectionReport *report){
+  int record[4] = {ADD_CONNECTION, start, end, 1};
+  if(environmentRecorder()){
+    traceConnect(environmentRecorder(), start, end);
+  }
+  if(! problem->incremental){
+    problem->incremental = newIncremental(problem->graph,
+      problem->numServers);
+  }
+  if(! addConnection(problem->incremental, start, end, 1, report)){
+    return 0;
+  }
+  /* Hashed the same way as an added connection in a change log. A snapshot
+    made for the old network no longer applies. */
+  problem->networkHash = hashInts(problem->networkHash, record, 4);
+  freeSnapshot(problem->snapshot);
+  problem->snapshot = NULL;
+  return 1;
+}
+
 struct solution *findSolution(struct graphProblem *problem,
   enum problemPart part){
-  return graphSolve(problem->graph, part, problem->numServers,
-    problem->outageCount, problem->outageSIDs);
+  struct solution *solution = NULL;
+  if(environmentRecorder()){
+    traceQuery(environmentRecorder(), part);
+  }
+  /* Tasks 2, 3 and 7 are kept up to date once connections are being added. */
+  if(problem->incremental &&
+    (part == TASK_2 || part == TASK_3 || part == TASK_7)){
+    return incrementalSolution(problem->incremental, part);
+  }
+  if(! problem->workspace){
+    problem->workspace = newWorkspace(problem->numServers);
+  }
+  if(problem->snapshot){
+    solution = snapshotSolve(problem->snapshot, problem->workspace,
+      problem->graph, part, problem->numServers, problem->outageCount,
+      problem->outageSIDs);
+    if(solution){
+      return solution;
+    }
+  }
+  solution = graphSolveWith(problem->workspace, problem->graph, part,
+    problem->numServers, problem->outageCount, problem->outageSIDs);
+  if(problem->snapshot){
+    snapshotRecord(problem->snapshot, problem->workspace, problem->graph, part,
+      solution, problem->numServers);
+  }
+  return solution;
+}
+
+struct solution *findDiameterWithin(struct graphProblem *problem,
+  int milliseconds){
+  struct solution *solution = (struct solution *)
+    malloc(sizeof(struct solution));
+  assert(solution);
+  /* Meant for large networks, so the mask is kept off the stack. */
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  initaliseSolution(solution);
+  if(environmentRecorder()){
+    traceDiameterWithin(environmentRecorder(), milliseconds);
+  }
+  if(! problem->workspace){
+    problem->workspace = newWorkspace(problem->numServers);
+  }
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  maskRemoved(problem->graph, outageMask, problem->numServers);
+  getDiameterWithin(problem->workspace, problem->graph, problem->numServers,
+    outageMask, milliseconds, solution);
+  free(outageMask);
+  return solution;
+}
+
+struct solution *findShardedSolution(struct graphProblem *problem,
+  enum problemPart part, int numShards){
+  return shardedSolve(problem->graph, part, problem->numServers,
+    problem->outageCount, problem->outageSIDs, numShards);
+}
+
+struct centrality *findBetweenness(struct graphProblem *problem, int samples,
+  int numThreads, unsigned int seed){
+  struct centrality *c;
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  maskRemoved(problem->graph, outageMask, problem->numServers);
+  c = getBetweenness(problem->graph, problem->numServers, outageMask, samples,
+    numThreads, seed);
+  free(outageMask);
+  return c;
+}
+
+struct separationPairs *findSeparationPairs(struct graphProblem *problem,
+  int numThreads){
+  struct separationPairs *pairs;
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  pairs = getSeparationPairs(problem->graph, problem->numServers, outageMask,
+    numThreads);
+  free(outageMask);
+  return pairs;
+}
+
+struct resilience *findResilience(struct graphProblem *problem,
+  enum failureModel model, double level, int trials, int numThreads,
+  unsigned int seed){
+  struct resilience *r;
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  maskRemoved(problem->graph, outageMask, problem->numServers);
+  r = simulateFailures(problem->graph, problem->numServers, outageMask, model,
+    level, trials, numThreads, seed);
+  free(outageMask);
+  return r;
+}
+
+struct distanceIndex *findDistanceIndex(struct graphProblem *problem){
+  struct distanceIndex *index;
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  index = buildDistanceIndex(problem->graph, problem->numServers, outageMask);
+  free(outageMask);
+  return index;
+}
+
+struct neighbourhoods *findNeighbourhoods(struct graphProblem *problem,
+  int numQueries, int querySizes[], int *querySources[], int maxHops,
+  int listMembers){
+  struct neighbourhoods *n;
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  maskRemoved(problem->graph, outageMask, problem->numServers);
+  n = getNeighbourhoods(problem->graph, problem->numServers, outageMask,
+    numQueries, querySizes, querySources, maxHops, listMembers);
+  free(outageMask);
+  return n;
+}
+
+struct triangles *findTriangles(struct graphProblem *problem, int numThreads){
+  struct triangles *t;
+  int *outageMask = (int *) malloc(sizeof(int) * (problem->numServers + 1));
+  assert(outageMask);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  maskRemoved(problem->graph, outageMask, problem->numServers);
+  t = getTriangles(problem->graph, problem->numServers, outageMask,
+    numThreads);
+  free(outageMask);
+  return t;
+}
+
+struct components *findComponents(struct graphProblem *problem,
+  int afterOutage){
+  int *outageMask;
+  if(! problem->workspace){
+    problem->workspace = newWorkspace(problem->numServers);
+  }
+  if(! afterOutage){
+    return getComponents(problem->workspace, problem->graph,
+      problem->numServers, NULL);
+  }
+  /* The labels live in the same workspace, so its mask is free to use. */
+  outageMask = workspaceOutageMask(problem->workspace);
+  getOutageMask(outageMask, problem->numServers, problem->outageSIDs,
+    problem->outageCount);
+  maskRemoved(problem->graph, outageMask, problem->numServers);
+  return getComponents(problem->workspace, problem->graph,
+    problem->numServers, outageMask);
 }
 
 void freeProblem(struct graphProblem *problem){
@@ -72,6 +380,9 @@ void freeProblem(struct graphProblem *problem){
   if(problem->outageSIDs){
     free(problem->outageSIDs);
   }
+  freeSnapshot(problem->snapshot);
+  freeIncremental(problem->incremental);
+  freeWorkspace(problem->workspace);
   freeGraph(problem->graph);
   free(problem);
 }
@@ -90,6 +401,12 @@ void freeSolution(struct solution *solution){
   if(solution->criticalServerSIDs){
     free(solution->criticalServerSIDs);
   }
+  if(solution->eccentricities){
+    free(solution->eccentricities);
+  }
+  if(solution->centreSIDs){
+    free(solution->centreSIDs);
+  }
   free(solution);
 }
 
@@ -106,4 +423,19 @@ void initaliseSolution(struct solution *solution){
   solution->postOutageDiameterSIDs = NULL;
   solution->criticalServerCount = 0;
   solution->criticalServerSIDs = NULL;
+  solution->eccentricityCount = 0;
+  solution->eccentricities = NULL;
+  solution->eccentricityTraversals = 0;
+  solution->postOutageRadius = 0;
+  solution->centreCount = 0;
+  solution->centreSIDs = NULL;
+  solution->postOutageDiameterBound = 0;
+  solution->postOutageDiameterExact = 0;
+  solution->diameterTraversals = 0;
+}
+
+double nowMilliseconds(void){
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
 }
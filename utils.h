@@ -10,6 +10,27 @@ Skeleton written by Grady Fitzpatrick for COMP20007 Assignment 1 2021
 #include <stdio.h>
 /* Because we use struct graph in this file, we should include graph.h here. */
 #include "graph.h"
+/* Because we use struct connectionReport in this file, we should include
+  incremental.h here. */
+#include "incremental.h"
+/* Because we use struct centrality in this file, we should include
+  centrality.h here. */
+#include "centrality.h"
+/* Because we use struct separationPairs in this file, we should include
+  separation.h here. */
+#include "separation.h"
+/* Because we use enum failureModel and struct resilience in this file, we
+  should include resilience.h here. */
+#include "resilience.h"
+/* Because we use struct distanceIndex in this file, we should include
+  distindex.h here. */
+#include "distindex.h"
+/* Because we use struct neighbourhoods in this file, we should include
+  neighbourhood.h here. */
+#include "neighbourhood.h"
+/* Because we use struct triangles in this file, we should include
+  triangles.h here. */
+#include "triangles.h"
 /* The problem specified. */
 struct graphProblem;
 
@@ -17,10 +38,79 @@ struct graphProblem;
 information. */
 struct graphProblem *readProblem(FILE *outageFile, FILE *networkFile);
 
+/* Applies a change log to the problem's network as one batch. Each line is
+  "+ start end [cost]" to add a connection, "- start end" to delete one or
+  "x server" to decommission a server. Returns the number of changes which
+  took effect. Any snapshot in use is dropped, choose one after the changes
+  are applied. */
+int applyChangeLog(struct graphProblem *problem, FILE *changeFile);
+
+/* Adds a connection to the problem's network, keeping the subnetworks and
+  critical servers up to date instead of finding them again for Tasks 2, 3 and
+  7. Fills in report and returns 1, or returns 0 if the connection was refused
+  because one of its ends is decommissioned. Any snapshot in use is
+  dropped. */
+int addProblemConnection(struct graphProblem *problem, int start, int end,
+  struct connectionReport *report);
+
+/* Keeps the structures derived for this problem in the snapshot file at path,
+  reusing them if the file was made for the same network and outage. */
+void useSnapshot(struct graphProblem *problem, const char *path);
+
 /* Finds a solution for a given problem. */
 struct solution *findSolution(struct graphProblem *problem,
   enum problemPart part);
 
+/* Finds the post-outage diameter as closely as possible within the given
+  number of milliseconds, giving the longest path found and a certified upper
+  bound. The two are equal if the diameter was found exactly. */
+struct solution *findDiameterWithin(struct graphProblem *problem,
+  int milliseconds);
+
+/* Finds the solution to Task 2, 3 or 4 with the servers split between
+  numShards worker processes, giving the same solution as findSolution. */
+struct solution *findShardedSolution(struct graphProblem *problem,
+  enum problemPart part, int numShards);
+
+/* Finds the betweenness of every server after the outage with numThreads
+  threads, from samples sources picked with seed or from every server if
+  samples is 0. */
+struct centrality *findBetweenness(struct graphProblem *problem, int samples,
+  int numThreads, unsigned int seed);
+
+/* Finds every pair of servers, neither critical alone, which disconnect the
+  network left after the outage when both fail, using numThreads threads. */
+struct separationPairs *findSeparationPairs(struct graphProblem *problem,
+  int numThreads);
+
+/* Runs trials random failures on top of the outage with numThreads threads,
+  failing servers as given by model and level, with streams seeded by seed. */
+struct resilience *findResilience(struct graphProblem *problem,
+  enum failureModel model, double level, int trials, int numThreads,
+  unsigned int seed);
+
+/* Builds the point to point distance index for the network after the
+  outage. */
+struct distanceIndex *findDistanceIndex(struct graphProblem *problem);
+
+/* Finds the servers within maxHops of each of numQueries sets of servers
+  after the outage, listing them if listMembers is 1. */
+struct neighbourhoods *findNeighbourhoods(struct graphProblem *problem,
+  int numQueries, int querySizes[], int *querySources[], int maxHops,
+  int listMembers);
+
+/* Counts the triangles and clustering of every server after the outage with
+  numThreads threads. */
+struct triangles *findTriangles(struct graphProblem *problem, int numThreads);
+
+/* Labels the subnetwork of every server, either before or after the outage.
+  The labels belong to the problem and stay valid until its next solution. */
+struct components *findComponents(struct graphProblem *problem,
+  int afterOutage);
+
 /* Frees all data used by problem. */
 void freeProblem(struct graphProblem *problem);
 
+/* Returns the milliseconds since an arbitrary fixed point, for timing. */
+double nowMilliseconds(void);
+